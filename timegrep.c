@@ -33,6 +33,19 @@
 #endif
 
 #include <pcre.h>
+#ifdef TG_WITH_ZLIB
+    #include <zlib.h>
+#endif
+#ifdef TG_WITH_ZSTD
+    #include <zstd.h>
+#endif
+#ifdef TG_WITH_LZMA
+    #include <lzma.h>
+    /* lzma_file_info_decoder is stable since liblzma 5.4.0, xz input is compiled out for older */
+    #if LZMA_VERSION < 50040002
+        #undef TG_WITH_LZMA
+    #endif
+#endif
 #include <time.h>
 #include <stdio.h>
 #include <fcntl.h>
@@ -43,10 +56,16 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <dirent.h>
+#include <pthread.h>
 #include <libintl.h>
+#include <poll.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <sys/time.h>
+#ifdef __linux__
+    #include <sys/sendfile.h>
+#endif
 
 /**
  * Program version for --version, -v
@@ -64,6 +83,123 @@ static const char* TG_VERSION = "0.7";
     #error "TG_CHUNK_SIZE must be aligned to 8192 bytes"
 #endif
 
+/**
+ * Default bytes between sparse index entries (1MB)
+ */
+#ifndef TG_INDEX_STEP
+    #define TG_INDEX_STEP (1024 * 1024)
+#endif
+
+/**
+ * Default clock skew between file modification time and its timestamps (--mtime-slack)
+ * Covers timestamps written in other timezone than parsed in
+ */
+#ifndef TG_MTIME_SLACK
+#define TG_MTIME_SLACK (24 * 60 * 60)
+#endif
+
+/**
+ * Maximum number of threads and minimum bytes per thread of --verify-sorted
+ */
+#define TG_VERIFY_THREADS 64
+#define TG_VERIFY_SLICE   TG_CHUNK_SIZE
+
+/**
+ * Default maximum string length of stream buffered at once (1MB, see tg_read_stream_string)
+ */
+#ifndef TG_MAX_LINE_LENGTH
+    #define TG_MAX_LINE_LENGTH (1024 * 1024)
+#endif
+
+/**
+ * Maximum number of --jobs threads
+ */
+#define TG_JOBS_THREADS 64
+
+/**
+ * Default block size of --jobs stream pipeline (1MB)
+ */
+#ifndef TG_STREAM_BLOCK
+    #define TG_STREAM_BLOCK (1024 * 1024)
+#endif
+
+/**
+ * Sparse index file suffix and magic (see tg_file_index)
+ */
+#define TG_INDEX_SUFFIX ".tgidx"
+#define TG_INDEX_MAGIC  "TGIDX01"
+
+/**
+ * Default uncompressed bytes between gzip checkpoints (16MB), deflate window size,
+ * maximum compressed bytes per inflate call and checkpoint index magic (see tg_gzip_index)
+ */
+#ifndef TG_GZIP_SPAN
+    #define TG_GZIP_SPAN (16 * 1024 * 1024)
+#endif
+
+#define TG_GZIP_WINDOW 32768
+#define TG_GZIP_INPUT  (1024 * 1024 * 1024)
+#define TG_GZIP_MAGIC  "TGGZI01"
+
+/**
+ * zstd frame magics (seekable format seek table is skippable frame at end of file)
+ */
+#define TG_ZSTD_MAGIC            0xFD2FB528UL
+#define TG_ZSTD_SKIPPABLE_MAGIC  0x184D2A50UL
+#define TG_ZSTD_SEEK_TABLE_MAGIC 0x184D2A5EUL
+#define TG_ZSTD_SEEKABLE_MAGIC   0x8F92EAB1UL
+
+/**
+ * xz stream header magic
+ */
+#define TG_XZ_MAGIC "\xFD" "7zXZ"
+
+/**
+ * Maximum decompressed size of last zstd frame or xz block to search last timestamp in (64MB)
+ */
+#define TG_LAST_BLOCK_SIZE (64 * 1024 * 1024)
+
+/**
+ * State file magic (see tg_state_timegrep)
+ */
+#define TG_STATE_MAGIC "TGSTA01"
+
+/**
+ * Maximum size of rendered datetime for lexicographic compare
+ */
+#define TG_KEY_SIZE 64
+
+/**
+ * Number of datetime matches after the same delimiter to trust learned anchor
+ */
+#define TG_ANCHOR_LEARN 4
+
+/**
+ * Minimum of auto detected datetime scan window in bytes (see tg_window)
+ */
+#define TG_WINDOW_MIN 4096
+
+/**
+ * Initial step in bytes of galloping search from end of data (see tg_tail_search)
+ */
+#define TG_GALLOP_SIZE (64 * 1024)
+
+/**
+ * Maximum number of probes kept between start and stop searches (see tg_probes)
+ */
+#define TG_PROBES_SIZE 256
+
+/**
+ * Block size in bytes to search string boundaries in (see tg_get_string_start)
+ */
+#define TG_SCAN_BLOCK 4096
+
+/**
+ * Block size in bytes to search datetime candidates over many strings at once
+ * (see tg_block_search)
+ */
+#define TG_BLOCK_SIZE (64 * 1024)
+
 /**
  * Use TG_TIMEZONE instead glibc timezone external variable
  * to compile on FreeBSD and other "non linux"
@@ -78,6 +214,66 @@ static const int TG_NOT_FOUND = 1;    /* nothing found       */
 static const int TG_NULL      = 0;    /* undetermined result */
 static const int TG_ERROR     = -1;   /* unrecoverable error */
 
+/**
+ * Datetime anchor modes (--anchor)
+ */
+static const int TG_ANCHOR_AUTO  = 0;   /* learn datetime position from matched strings */
+static const int TG_ANCHOR_START = 1;   /* datetime always starts the string            */
+static const int TG_ANCHOR_NONE  = 2;   /* always search datetime in whole string       */
+
+/**
+ * File search strategies (--search)
+ */
+static const int TG_SEARCH_AUTO          = 0;   /* tail if --stop is now, else interpolation */
+static const int TG_SEARCH_BINARY        = 1;   /* halve search range on every probe         */
+static const int TG_SEARCH_INTERPOLATION = 2;   /* interpolate probe position by timestamp   */
+static const int TG_SEARCH_TAIL          = 3;   /* gallop backward from end of data          */
+
+/**
+ * Compressed file formats (see tg_file_compressed)
+ */
+static const int TG_COMPRESSED_NONE = 0;   /* plain text      */
+#ifdef TG_WITH_ZLIB
+static const int TG_COMPRESSED_GZIP = 1;   /* gzip (RFC 1952) */
+#endif
+#ifdef TG_WITH_ZSTD
+static const int TG_COMPRESSED_ZSTD = 2;   /* zstd (RFC 8878) */
+#endif
+#ifdef TG_WITH_LZMA
+static const int TG_COMPRESSED_XZ   = 3;   /* xz              */
+#endif
+
+/**
+ * Civil date cache of tg_timegm
+ */
+typedef struct {
+    int    year;   /* cached day year (tm_year)                */
+    int    month;  /* cached day month (tm_mon)                */
+    int    day;    /* cached day of month (tm_mday) or 0       */
+    time_t base;   /* timestamp of cached day midnight (GMT)   */
+} tg_civil;
+
+/**
+ * Dedicated datetime scanner for predefined format (see tg_get_timestamp)
+ * timestamp may be NULL to locate datetime only
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Return TG_NULL if undetermined, so regular expression must be used
+ */
+typedef int (*tg_scanner)(
+    const char* string,      /* source string                */
+    size_t      length,      /* source string length         */
+    tg_civil*   civil,       /* civil date cache             */
+    size_t*     offset,      /* result datetime start offset */
+    time_t*     timestamp    /* result timestamp             */
+);
+
+static int tg_scan_default(const char* string, size_t length, tg_civil* civil, size_t* offset, time_t* timestamp);
+static int tg_scan_iso(const char* string, size_t length, tg_civil* civil, size_t* offset, time_t* timestamp);
+static int tg_scan_common(const char* string, size_t length, tg_civil* civil, size_t* offset, time_t* timestamp);
+static int tg_scan_syslog(const char* string, size_t length, tg_civil* civil, size_t* offset, time_t* timestamp);
+static int tg_scan_tskv(const char* string, size_t length, tg_civil* civil, size_t* offset, time_t* timestamp);
+
 /**
  * Predefined datetime formats
  */
@@ -85,35 +281,59 @@ static const struct {
     const char* name;     /* format name                    */
     const char* alias;    /* format alias                   */
     const char* format;   /* datetime format (see strptime) */
+    tg_scanner  scan;     /* dedicated scanner              */
 } TG_FORMATS[] = {
     {
         "default",
         NULL,
-        "%Y-%m-%d %H:%M:%S"
+        "%Y-%m-%d %H:%M:%S",
+        tg_scan_default
     },
     {
         "iso",
         NULL,
-        "%Y-%m-%dT%H:%M:%S%z"
+        "%Y-%m-%dT%H:%M:%S%z",
+        tg_scan_iso
     },
     {
         "common",
         NULL,
-        "%d/%b/%Y:%H:%M:%S %z"
+        "%d/%b/%Y:%H:%M:%S %z",
+        tg_scan_common
     },
     {
         "syslog",
         NULL,
-        "%b %d %H:%M:%S"
+        "%b %d %H:%M:%S",
+        tg_scan_syslog
     },
     {
         "tskv",
         NULL,
-        "unixtime=%s"
+        "unixtime=%s",
+        tg_scan_tskv
     },
-    { "apache", "common", NULL },
-    { "nginx",  "common", NULL },
-    { NULL,     NULL,     NULL }
+    { "apache", "common", NULL, NULL },
+    { "nginx",  "common", NULL, NULL },
+    { NULL,     NULL,     NULL, NULL }
+};
+
+/**
+ * English month names (abbreviated form is first three chars)
+ */
+static const char* TG_MONTHS[] = {
+    "January",
+    "February",
+    "March",
+    "April",
+    "May",
+    "June",
+    "July",
+    "August",
+    "September",
+    "October",
+    "November",
+    "December"
 };
 
 /**
@@ -146,8 +366,121 @@ typedef struct {
     const char* format;      /* datetime format for tg_strptime                    */
     int         format_tz;   /* datetime format use timezone information           */
     int         fallback;    /* force use tg_strptime                              */
+    tg_scanner  scan;        /* dedicated scanner for predefined format or NULL    */
+    size_t      lexical;     /* length of order-preserving datetime or 0           */
+    tg_civil    civil;       /* civil date cache                                   */
+    int         anchor;      /* datetime anchor mode (TG_ANCHOR_*)                 */
+    int         delim;       /* learned delimiter before datetime or -1 for start  */
+    size_t      delim_nth;   /* learned delimiter occurrence number                */
+    int         delim_hits;  /* matches after learned delimiter (majority vote)    */
+    size_t      window;      /* datetime scan window or 0 for whole string         */
+    int         window_auto; /* detect datetime scan window from matches           */
+    size_t      reach;       /* maximum end offset of matched datetime             */
 } tg_parser;
 
+/**
+ * datetime of single string
+ */
+typedef struct {
+    time_t      timestamp;   /* timestamp (valid if key is NULL)                 */
+    const char* key;         /* datetime bytes for lexicographic compare or NULL */
+} tg_stamp;
+
+/**
+ * timestamped string seen by file search
+ */
+typedef struct {
+    size_t      start;       /* string start                                      */
+    size_t      length;      /* string length or SIZE_MAX (see tg_get_string)     */
+    tg_stamp    stamp;       /* string datetime                                   */
+} tg_probe;
+
+/**
+ * probes of start search to bracket stop search
+ */
+typedef struct {
+    size_t      count;                   /* number of probes */
+    tg_probe    probe[TG_PROBES_SIZE];   /* probes           */
+} tg_probes;
+
+/**
+ * sparse index file header (see tg_file_index)
+ */
+typedef struct {
+    char        magic[8];    /* TG_INDEX_MAGIC                  */
+    uint64_t    ino;         /* indexed file inode              */
+    uint64_t    size;        /* indexed file size               */
+    int64_t     mtime;       /* indexed file modification time  */
+    uint64_t    format;      /* datetime format hash            */
+    int64_t     timezone;    /* TG_TIMEZONE of timestamps       */
+    uint64_t    step;        /* bytes between entries           */
+    uint64_t    count;       /* number of entries               */
+} tg_index_header;
+
+/**
+ * sparse index entry - first timestamped string after every step bytes
+ */
+typedef struct {
+    uint64_t    offset;      /* string start                    */
+    int64_t     timestamp;   /* string timestamp                */
+} tg_index_entry;
+
+/**
+ * state file of previous run (--state)
+ */
+typedef struct {
+    char        magic[8];    /* TG_STATE_MAGIC                  */
+    uint64_t    dev;         /* device of file                  */
+    uint64_t    ino;         /* inode of file                   */
+    uint64_t    offset;      /* end of last complete output     */
+} tg_state;
+
+/**
+ * timestamp decrease found by --verify-sorted
+ */
+typedef struct {
+    size_t      offset;      /* string start                    */
+    time_t      timestamp;   /* string timestamp                */
+    time_t      previous;    /* previous string timestamp       */
+} tg_inversion;
+
+/**
+ * stream data source with read(2) semantics (see tg_read_stream_string)
+ */
+typedef struct {
+    ssize_t   (*read)(void* source, char* buffer, size_t size);   /* read function          */
+    void*     source;                                             /* read function argument */
+} tg_reader;
+
+/**
+ * file of rotation set (see tg_files_timegrep)
+ */
+typedef struct {
+    const char* filename;    /* filename                        */
+    size_t      order;       /* order in arguments              */
+    size_t      size;        /* file size on search             */
+    dev_t       dev;         /* file device on search           */
+    ino_t       ino;         /* file inode on search            */
+    time_t      mtime;       /* file modification time on search */
+    size_t      lbound;      /* output range start              */
+    size_t      ubound;      /* output range end                */
+    time_t      first;       /* first timestamp                 */
+    time_t      last;        /* last timestamp                  */
+    int         result;      /* search result                   */
+    int         compressed;  /* compressed file format          */
+    size_t      point;       /* checkpoint / frame to decompress from */
+    int         whole;       /* print whole decompressed file   */
+} tg_file;
+
+/**
+ * list of files to search (see tg_files_collect)
+ */
+typedef struct {
+    char**      filename;    /* filenames                       */
+    size_t      count;       /* number of filenames             */
+    size_t      alloc;       /* allocated number of filenames   */
+} tg_filenames;
+
 /**
  * working context
  */
@@ -155,11 +488,27 @@ typedef struct {
     const char* filename;   /* current filename             */
     int         fd;         /* file descriptor              */
     size_t      size;       /* size of file / mapped memory */
+    size_t      hole;       /* size of leading sparse hole  */
     char*       data;       /* mapped memory                */
     time_t      start;      /* timestamp from search        */
     time_t      stop;       /* timestamp to search          */
+    char        start_key[TG_KEY_SIZE];   /* start rendered for lexicographic compare */
+    char        stop_key[TG_KEY_SIZE];    /* stop rendered for lexicographic compare  */
     size_t      chunk;      /* io / memory chunk size       */
+    int         search;     /* file search strategy         */
+    int         index;      /* build sparse index and exit  */
+    const char* state;      /* state file or NULL           */
+    int         verify;     /* verify files are sorted      */
+    time_t      tolerance;  /* allowed timestamp decrease   */
+    int         recursive;  /* search directories recursive */
+    time_t      mtime_slack; /* allowed mtime clock skew    */
+    size_t      jobs;       /* threads to search files      */
+    size_t      max_line;   /* stream string part length    */
+    int         merge;      /* merge files by datetime      */
+    char*       index_data; /* mapped sparse index file     */
+    size_t      index_size; /* size of sparse index file    */
     tg_parser   parser;     /* datetime parser context      */
+    tg_probes   probes;     /* probes of start search       */
 } tg_context;
 
 /**
@@ -187,14 +536,34 @@ static void tg_print_help()
     printf("\n\n");
     printf(gettext(
         "Options:\n"
-        "   --format,  -e -- datetime format (default: 'default')\n"
-        "   --start,   -f -- datetime to start search (default: now)\n"
-        "   --stop,    -t -- datetime to stop search (default: now)\n"
-        "   --seconds, -s -- seconds to substract from --start (default: 0)\n"
-        "   --minutes, -m -- minutes to substract from --start (default: 0)\n"
-        "   --hours,   -h -- hours to substract from --start (default: 0)\n"
-        "   --version, -v -- print program version and exit\n"
-        "   --help,    -? -- print this help message"
+        "   --format,    -e -- datetime format (default: 'default')\n"
+        "   --start,     -f -- datetime to start search (default: now)\n"
+        "   --stop,      -t -- datetime to stop search (default: now)\n"
+        "   --seconds,   -s -- seconds to substract from --start (default: 0)\n"
+        "   --minutes,   -m -- minutes to substract from --start (default: 0)\n"
+        "   --hours,     -h -- hours to substract from --start (default: 0)\n"
+    ));
+    printf(gettext(
+        "   --anchor,    -a -- datetime position: auto, start or none (default: auto)\n"
+        "   --ts-window, -w -- bytes from line start to search datetime in, 0 for whole line (default: auto)\n"
+        "   --search,    -S -- file search strategy: auto, binary, interpolation or tail (default: auto)\n"
+    ));
+    printf(gettext(
+        "   --build-index, -i -- build sparse index <file>.tgidx of files and exit\n"
+        "   --state,     -T -- state file to continue from where previous run stopped\n"
+        "   --verify-sorted, -c -- verify files are sorted, print datetime decreases and exit\n"
+        "   --tolerance, -l -- seconds of datetime decrease ignored by --verify-sorted (default: 0)\n"
+    ));
+    printf(gettext(
+        "   --recursive, -R -- search files in directories recursive\n"
+        "   --mtime-slack, -k -- skip files of directories modified before --start by more than seconds (default: 86400)\n"
+        "   --jobs,      -j -- threads to search files or parse stdin, 0 for number of processors (default: 1)\n"
+        "   --merge,     -M -- merge strings of files by datetime\n"
+        "   --max-line-length, -L -- bytes of stream line buffered and parsed, 0 for unlimited (default: 1048576)\n"
+    ));
+    printf(gettext(
+        "   --version,   -v -- print program version and exit\n"
+        "   --help,      -? -- print this help message"
     ));
     printf("\n\n");
     printf(gettext(
@@ -626,6 +995,207 @@ static size_t tg_strptime_regex(const char* format, char* regex, int* format_tz,
     return result;
 }
 
+/**
+ * Internal recursion of tg_strftime_lexical
+ * Return SIZE_MAX if format is not order-preserving or datetime can not be rendered
+ */
+static size_t tg_strftime_lexical_rank(const char* format, const struct tm* tm, char* key, int* rank)
+{
+    char        c;
+    size_t      format_index;
+    size_t      format_length;
+    size_t      key_index;
+    size_t      width;
+    int         field;
+    int         value;
+    const char* part;
+    size_t      part_length;
+
+    format_length = strlen(format);
+    key_index     = 0;
+
+    for (format_index = 0; format_index < format_length; format_index++) {
+        c = format[format_index];
+        if (c != '%') {
+            if (key != NULL)
+                key[key_index] = c;
+
+            key_index++;
+
+            continue;
+        } else if (format_index + 1 == format_length)
+            return SIZE_MAX;
+
+        c = format[format_index + 1];
+        format_index++;
+
+        part  = NULL;
+        field = -1;
+        value = 0;
+        width = 2;
+
+        /* fixed width numeric fields in order of significance, see tg_strptime_regex_nsc */
+        switch (c) {
+            case '%':
+                if (key != NULL)
+                    key[key_index] = '%';
+
+                key_index++;
+                break;
+            case 'c':
+                part = "%x %X";
+                break;
+            case 'F':
+            case 'x':
+                part = "%Y-%m-%d";
+                break;
+            case 'R':
+                part = "%H:%M";
+                break;
+            case 'T':
+            case 'X':
+                part = "%H:%M:%S";
+                break;
+            case 'Y':
+                field = 0;
+                width = 4;
+                value = (tm == NULL ? 0 : tm->tm_year + 1900);
+                break;
+            case 'm':
+                field = 1;
+                value = (tm == NULL ? 0 : tm->tm_mon + 1);
+                break;
+            case 'd':
+                field = 2;
+                value = (tm == NULL ? 0 : tm->tm_mday);
+                break;
+            case 'H':
+                field = 3;
+                value = (tm == NULL ? 0 : tm->tm_hour);
+                break;
+            case 'M':
+                field = 4;
+                value = (tm == NULL ? 0 : tm->tm_min);
+                break;
+            case 'S':
+                field = 5;
+                value = (tm == NULL ? 0 : tm->tm_sec);
+                break;
+            default:
+                return SIZE_MAX;
+        }
+
+        if (part != NULL) {
+            part_length = tg_strftime_lexical_rank(part, tm, (key == NULL ? NULL : &key[key_index]), rank);
+            if (part_length == SIZE_MAX)
+                return SIZE_MAX;
+
+            key_index += part_length;
+
+        } else if (field >= 0) {
+            if (field != *rank || value < 0 || value >= (width == 4 ? 10000 : 100))
+                return SIZE_MAX;
+
+            (*rank)++;
+
+            if (key != NULL) {
+                if (width == 4) {
+                    key[key_index++] = (char)('0' + value / 1000);
+                    key[key_index++] = (char)('0' + value / 100 % 10);
+                }
+
+                key[key_index++] = (char)('0' + value / 10 % 10);
+                key[key_index++] = (char)('0' + value % 10);
+            } else
+                key_index += width;
+        }
+    }
+
+    return key_index;
+}
+
+/**
+ * Render timestamp to datetime format for lexicographic compare
+ * Format is order-preserving only if it consists of literals and zero padded
+ * %Y, %m, %d, %H, %M, %S (each exactly once and in this order), so byte order
+ * of rendered datetime equals time order
+ * key and timestamp may be NULL to found result key length
+ * Return length of result key on success
+ * Return SIZE_MAX if format is not order-preserving or timestamp can not be rendered
+ */
+static size_t tg_strftime_lexical(const char* format, const time_t* timestamp, char* key)
+{
+    size_t    result;
+    int       rank;
+    time_t    local;
+    struct tm tm;
+
+    if (timestamp != NULL) {
+        local = (*timestamp) + TG_TIMEZONE;
+        if (gmtime_r(&local, &tm) == NULL)
+            return SIZE_MAX;
+    }
+
+    rank   = 0;
+    result = tg_strftime_lexical_rank(format, (timestamp == NULL ? NULL : &tm), key, &rank);
+
+    if (rank != 6)
+        return SIZE_MAX;
+
+    return result;
+}
+
+/**
+ * Convert broken-down GMT time to a time_t like timegm, but without normalization
+ * of struct tm and timezone lookups (days from civil date algorithm)
+ * Days since epoch are cached, so datetimes of the same day cost only
+ * hour / minute / second arithmetic
+ * civil may be NULL
+ */
+static time_t tg_timegm(const struct tm* tm, tg_civil* civil)
+{
+    long int year;
+    long int month;
+    long int era;
+    long int yoe;
+    long int doy;
+    long int doe;
+    time_t   base;
+
+    if (civil != NULL && civil->day != 0 && civil->day == tm->tm_mday && civil->month == tm->tm_mon && civil->year == tm->tm_year)
+        base = civil->base;
+    else {
+        /* month 1-12 with year carry, days of month are linear as in timegm */
+        year  = (long int)tm->tm_year + 1900 + tm->tm_mon / 12;
+        month = tm->tm_mon % 12;
+        if (month < 0) {
+            month += 12;
+            year--;
+        }
+        month++;
+
+        /* http://howardhinnant.github.io/date_algorithms.html#days_from_civil */
+        if (month <= 2)
+            year--;
+
+        era = (year >= 0 ? year : year - 399) / 400;
+        yoe = year - era * 400;
+        doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + tm->tm_mday - 1;
+        doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+        base = (time_t)(era * 146097 + doe - 719468) * 86400;
+
+        if (civil != NULL) {
+            civil->year  = tm->tm_year;
+            civil->month = tm->tm_mon;
+            civil->day   = tm->tm_mday;
+            civil->base  = base;
+        }
+    }
+
+    return base + (time_t)tm->tm_hour * 3600 + (time_t)tm->tm_min * 60 + tm->tm_sec;
+}
+
 /**
  * Convert a string representation of datetime to a time_t like strptime
  * Return TG_FOUND on success
@@ -635,6 +1205,7 @@ static int tg_strptime(
     const char* string,      /* source string                            */
     const char* format,      /* datetime format (see strptime)           */
     int         format_tz,   /* datetime format use timezone information */
+    tg_civil*   civil,       /* civil date cache or NULL                 */
     time_t*     timestamp    /* result timestamp                         */
 )
 {
@@ -650,7 +1221,7 @@ static int tg_strptime(
     else
         tm_gmtoff = tm.tm_gmtoff;
 
-    *timestamp = timegm(&tm) - tm_gmtoff;
+    *timestamp = tg_timegm(&tm, civil) - tm_gmtoff;
     if ((*timestamp) == -1)
         return TG_NOT_FOUND;
 
@@ -809,6 +1380,7 @@ static int tg_strptime_re(
     int*               matches,    /* offset vector that pcre_exec used                  */
     int                count,      /* value returned by pcre_exec                        */
     const tg_pcre_nsi* nsi,        /* named regular expressions indexes or fallback flag */
+    tg_civil*          civil,      /* civil date cache                                   */
     time_t*            timestamp   /* result timestamp                                   */
 )
 {
@@ -898,7 +1470,7 @@ static int tg_strptime_re(
     else
         tm_gmtoff = TG_TIMEZONE;
 
-    *timestamp = timegm(&tm) - tm_gmtoff;
+    *timestamp = tg_timegm(&tm, civil) - tm_gmtoff;
     if ((*timestamp) == -1)
         return TG_NOT_FOUND;
 
@@ -913,434 +1485,5352 @@ static int tg_strptime_re(
  */
 int tg_strptime_heuristic(const char* string, time_t* timestamp)
 {
-    if (tg_strptime(string, TG_FORMATS[0].format, 0, timestamp) == TG_FOUND)
+    if (tg_strptime(string, TG_FORMATS[0].format, 0, NULL, timestamp) == TG_FOUND)
         return TG_FOUND;
 
-    if (tg_strptime(string, "%Y-%m-%d", 0, timestamp) == TG_FOUND)
+    if (tg_strptime(string, "%Y-%m-%d", 0, NULL, timestamp) == TG_FOUND)
         return TG_FOUND;
-    if (tg_strptime(string, "%Y/%m/%d", 0, timestamp) == TG_FOUND)
+    if (tg_strptime(string, "%Y/%m/%d", 0, NULL, timestamp) == TG_FOUND)
         return TG_FOUND;
-    if (tg_strptime(string, "%Y.%m.%d", 0, timestamp) == TG_FOUND)
+    if (tg_strptime(string, "%Y.%m.%d", 0, NULL, timestamp) == TG_FOUND)
         return TG_FOUND;
 
-    if (tg_strptime(string, "%d-%m-%Y", 0, timestamp) == TG_FOUND)
+    if (tg_strptime(string, "%d-%m-%Y", 0, NULL, timestamp) == TG_FOUND)
         return TG_FOUND;
-    if (tg_strptime(string, "%d/%m/%Y", 0, timestamp) == TG_FOUND)
+    if (tg_strptime(string, "%d/%m/%Y", 0, NULL, timestamp) == TG_FOUND)
         return TG_FOUND;
-    if (tg_strptime(string, "%d.%m.%Y", 0, timestamp) == TG_FOUND)
+    if (tg_strptime(string, "%d.%m.%Y", 0, NULL, timestamp) == TG_FOUND)
         return TG_FOUND;
 
     return TG_NOT_FOUND;
 }
 
 /**
- * Search, parse and convert datetime to timestamp from single string
- * Return TG_FOUND on success
- * Return TG_NOT_FOUND if nothing found, parse or convert error
- * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ * Convert exactly two digits to int
+ * Return TG_ERROR if buffer does not start with two digits
  */
-static int tg_get_timestamp(
-    const char*      string,     /* source string           */
-    size_t           length,     /* source string length    */
-    const tg_parser* parser,     /* datetime parser context */
-    time_t*          timestamp   /* result timestamp        */
-)
+static int tg_atoi2(const char* buffer)
 {
-    int         result;
-    const char* match;
-    int         matches[30];
+    if (buffer[0] < '0' || buffer[0] > '9' || buffer[1] < '0' || buffer[1] > '9')
+        return TG_ERROR;
 
-    /* pcre_exec accept int as length */
-    if (length > (size_t)INT_MAX)
-        return TG_NOT_FOUND;
+    return (buffer[0] - '0') * 10 + (buffer[1] - '0');
+}
 
-    result = pcre_exec(parser->re, parser->extra, string, (int)length, 0, 0, matches, sizeof(matches) / sizeof(int));
-    if (result < 0) {
-        switch (result) {
-            case PCRE_ERROR_NOMATCH:
-            case PCRE_ERROR_BADUTF8:
-            case PCRE_ERROR_BADUTF8_OFFSET:
-#ifdef PCRE_ERROR_SHORTUTF8
-            case PCRE_ERROR_SHORTUTF8:
-#endif
-                return TG_NOT_FOUND;
-            case PCRE_ERROR_NOMEMORY:
-                errno = ENOMEM;
-                break;
-            default:
-                errno = 0;
-                fprintf(stderr, gettext("%s pcre_exec error %i\n"), gettext("ERROR:"), result);
-        }
+/**
+ * Convert exactly four digits to int
+ * Return TG_ERROR if buffer does not start with four digits
+ */
+static int tg_atoi4(const char* buffer)
+{
+    int high;
+    int low;
+
+    high = tg_atoi2(buffer);
+    low  = tg_atoi2(buffer + 2);
 
+    if (high == TG_ERROR || low == TG_ERROR)
         return TG_ERROR;
-    }
 
-    if (parser->fallback == 0)
-        result = tg_strptime_re(string, matches, result, &parser->nsi, timestamp);
-    else {
-        result = pcre_get_substring(string, matches, result, 0, &match);
-        if (result < 0) {
-            if (result == PCRE_ERROR_NOMEMORY)
+    return high * 100 + low;
+}
+
+/**
+ * Convert a string representation of English month name to a int
+ * Return month (0-11) and name length for full name match if full is not NULL
+ * Return TG_ERROR if buffer does not start with abbreviated month name
+ */
+static int tg_atom_exact(const char* buffer, size_t length, size_t* full)
+{
+    int    month;
+    size_t name_length;
+
+    if (length < 3)
+        return TG_ERROR;
+
+    month = tg_atom(buffer, 3);
+    if (month == TG_ERROR || memcmp(buffer, TG_MONTHS[month], 3) != 0)
+        return TG_ERROR;
+
+    if (full != NULL) {
+        name_length = strlen(TG_MONTHS[month]);
+        if (name_length > 3 && name_length <= length && memcmp(buffer, TG_MONTHS[month], name_length) == 0)
+            *full = name_length;
+        else
+            *full = 3;
+    }
+
+    return month;
+}
+
+/**
+ * Decode zero padded "YYYY-MM-DD" with the same value ranges as tg_strptime_regex
+ * Return TG_FOUND on success
+ * Return TG_NULL if string does not match strictly
+ */
+static int tg_scan_date(const char* string, struct tm* tm)
+{
+    int year;
+    int month;
+    int day;
+
+    year  = tg_atoi4(string);
+    month = tg_atoi2(string + 5);
+    day   = tg_atoi2(string + 8);
+
+    if (year == TG_ERROR || string[4] != '-' || string[7] != '-' ||
+        month < 1 || month > 12 || day < 1 || day > 31)
+        return TG_NULL;
+
+    tm->tm_year = year - 1900;
+    tm->tm_mon  = month - 1;
+    tm->tm_mday = day;
+
+    return TG_FOUND;
+}
+
+/**
+ * Decode zero padded "HH:MM:SS" with the same value ranges as tg_strptime_regex
+ * Return TG_FOUND on success
+ * Return TG_NULL if string does not match strictly
+ */
+static int tg_scan_clock(const char* string, struct tm* tm)
+{
+    int hour;
+    int minute;
+    int second;
+
+    hour   = tg_atoi2(string);
+    minute = tg_atoi2(string + 3);
+    second = tg_atoi2(string + 6);
+
+    if (string[2] != ':' || string[5] != ':' ||
+        hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60)
+        return TG_NULL;
+
+    tm->tm_hour = hour;
+    tm->tm_min  = minute;
+    tm->tm_sec  = second;
+
+    return TG_FOUND;
+}
+
+/**
+ * Decode numeric ("+0000", "+00:00") or "Z" timezone like tg_atogmtoff
+ * Return TG_FOUND on success
+ * Return TG_NULL if timezone is not one of strict forms
+ */
+static int tg_scan_gmtoff(const char* string, size_t length, size_t* used, long int* gmtoff)
+{
+    if (length >= 1 && string[0] == 'Z') {
+        *used   = 1;
+        *gmtoff = 0;
+        return TG_FOUND;
+    }
+
+    if (length < 5 || (string[0] != '+' && string[0] != '-') || tg_atoi2(string + 1) == TG_ERROR)
+        return TG_NULL;
+
+    if (tg_atoi2(string + 3) != TG_ERROR)
+        *used = 5;
+    else if (length >= 6 && string[3] == ':' && tg_atoi2(string + 4) != TG_ERROR)
+        *used = 6;
+    else
+        return TG_NULL;
+
+    *gmtoff = tg_atogmtoff(string, (int)(*used));
+
+    return TG_FOUND;
+}
+
+/**
+ * Convert datetime decoded by dedicated scanner to timestamp like tg_strptime_re
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND on convert error
+ */
+static int tg_scan_timestamp(const struct tm* tm, long int gmtoff, tg_civil* civil, time_t* timestamp)
+{
+    if (timestamp == NULL)
+        return TG_FOUND;
+
+    *timestamp = tg_timegm(tm, civil) - gmtoff;
+    if ((*timestamp) == -1)
+        return TG_NOT_FOUND;
+
+    return TG_FOUND;
+}
+
+/**
+ * Dedicated scanner for "default" format (%Y-%m-%d %H:%M:%S)
+ * Any match of format regex starts with four digits followed by '-'
+ */
+static int tg_scan_default(const char* string, size_t length, tg_civil* civil, size_t* offset, time_t* timestamp)
+{
+    const char* dash;
+    size_t      start;
+    struct tm   tm;
+
+    if (length < 5)
+        return TG_NOT_FOUND;
+
+    dash = string + 4;
+    while ((dash = memchr(dash, '-', length - (size_t)(dash - string))) != NULL) {
+        start = (size_t)(dash - string) - 4;
+        dash++;
+
+        if (tg_atoi4(string + start) == TG_ERROR)
+            continue;
+        else if ((size_t)(dash - string) == length || dash[0] < '0' || dash[0] > '9')
+            continue;
+
+        memset(&tm, 0, sizeof(tm));
+
+        if (length - start < 19 ||
+            tg_scan_date(string + start, &tm) != TG_FOUND ||
+            string[start + 10] != ' ' ||
+            tg_scan_clock(string + start + 11, &tm) != TG_FOUND)
+            return TG_NULL;
+
+        *offset = start;
+
+        return tg_scan_timestamp(&tm, TG_TIMEZONE, civil, timestamp);
+    }
+
+    return TG_NOT_FOUND;
+}
+
+/**
+ * Dedicated scanner for "iso" format (%Y-%m-%dT%H:%M:%S%z)
+ * Any match of format regex starts with four digits followed by '-'
+ */
+static int tg_scan_iso(const char* string, size_t length, tg_civil* civil, size_t* offset, time_t* timestamp)
+{
+    const char* dash;
+    size_t      start;
+    size_t      used;
+    long int    gmtoff;
+    struct tm   tm;
+
+    if (length < 5)
+        return TG_NOT_FOUND;
+
+    dash = string + 4;
+    while ((dash = memchr(dash, '-', length - (size_t)(dash - string))) != NULL) {
+        start = (size_t)(dash - string) - 4;
+        dash++;
+
+        if (tg_atoi4(string + start) == TG_ERROR)
+            continue;
+        else if ((size_t)(dash - string) == length || dash[0] < '0' || dash[0] > '9')
+            continue;
+
+        memset(&tm, 0, sizeof(tm));
+
+        if (length - start < 20 ||
+            tg_scan_date(string + start, &tm) != TG_FOUND ||
+            string[start + 10] != 'T' ||
+            tg_scan_clock(string + start + 11, &tm) != TG_FOUND ||
+            tg_scan_gmtoff(string + start + 19, length - start - 19, &used, &gmtoff) != TG_FOUND)
+            return TG_NULL;
+
+        *offset = start;
+
+        return tg_scan_timestamp(&tm, gmtoff, civil, timestamp);
+    }
+
+    return TG_NOT_FOUND;
+}
+
+/**
+ * Dedicated scanner for "common" format (%d/%b/%Y:%H:%M:%S %z)
+ * Any match of format regex contains day digit followed by '/' and month name
+ */
+static int tg_scan_common(const char* string, size_t length, tg_civil* civil, size_t* offset, time_t* timestamp)
+{
+    const char* slash;
+    size_t      position;
+    size_t      used;
+    long int    gmtoff;
+    int         day;
+    struct tm   tm;
+
+    if (length < 2)
+        return TG_NOT_FOUND;
+
+    slash = string + 1;
+    while ((slash = memchr(slash, '/', length - (size_t)(slash - string))) != NULL) {
+        position = (size_t)(slash - string);
+        slash++;
+
+        if (string[position - 1] < '0' || string[position - 1] > '9')
+            continue;
+        else if (tg_atom_exact(string + position + 1, length - position - 1, NULL) == TG_ERROR)
+            continue;
+
+        memset(&tm, 0, sizeof(tm));
+
+        if (length - position < 20 ||
+            string[position + 4] != '/' ||
+            tg_atoi4(string + position + 5) == TG_ERROR ||
+            string[position + 9] != ':' ||
+            tg_scan_clock(string + position + 10, &tm) != TG_FOUND ||
+            string[position + 18] != ' ' ||
+            tg_scan_gmtoff(string + position + 19, length - position - 19, &used, &gmtoff) != TG_FOUND)
+            return TG_NULL;
+
+        tm.tm_year = tg_atoi4(string + position + 5) - 1900;
+        tm.tm_mon  = tg_atom(string + position + 1, 3);
+
+        /* leftmost day as regex alternatives (10-29, 30-31, 01-09) would match it */
+        day = (position >= 2 ? tg_atoi2(string + position - 2) : TG_ERROR);
+        if (day >= 1 && day <= 31)
+            *offset = position - 2;
+        else if (string[position - 1] != '0') {
+            day     = string[position - 1] - '0';
+            *offset = position - 1;
+        } else
+            continue;
+
+        tm.tm_mday = day;
+
+        return tg_scan_timestamp(&tm, gmtoff, civil, timestamp);
+    }
+
+    return TG_NOT_FOUND;
+}
+
+/**
+ * Dedicated scanner for "syslog" format (%b %d %H:%M:%S)
+ * Any match of format regex starts with month name
+ */
+static int tg_scan_syslog(const char* string, size_t length, tg_civil* civil, size_t* offset, time_t* timestamp)
+{
+    size_t    position;
+    size_t    full;
+    int       month;
+    struct tm tm;
+
+    for (position = 0; position + 3 <= length; position++) {
+        if (memchr("ADFJMNOS", string[position], 8) == NULL)
+            continue;
+
+        month = tg_atom_exact(string + position, length - position, &full);
+        if (month == TG_ERROR)
+            continue;
+        else if (full == 3 && (position + 3 == length || string[position + 3] != ' '))
+            continue;
+
+        memset(&tm, 0, sizeof(tm));
+
+        if (full != 3 || length - position < 15)
+            return TG_NULL;
+
+        tm.tm_mday = tg_atoi2(string + position + 4);
+
+        if (tm.tm_mday < 1 || tm.tm_mday > 31 ||
+            string[position + 6] != ' ' ||
+            tg_scan_clock(string + position + 7, &tm) != TG_FOUND)
+            return TG_NULL;
+
+        tm.tm_mon = month;
+        *offset   = position;
+
+        return tg_scan_timestamp(&tm, TG_TIMEZONE, civil, timestamp);
+    }
+
+    return TG_NOT_FOUND;
+}
+
+/**
+ * Dedicated scanner for "tskv" format (unixtime=%s)
+ */
+static int tg_scan_tskv(const char* string, size_t length, tg_civil* civil, size_t* offset, time_t* timestamp)
+{
+    const char* key;
+    const char* digit;
+    const char* end;
+    int64_t     value;
+
+    (void)civil;
+
+    end = string + length;
+    key = string;
+
+    while ((key = memmem(key, (size_t)(end - key), "unixtime=", 9)) != NULL) {
+        value = 0;
+        digit = key + 9;
+
+        while (digit < end && *digit >= '0' && *digit <= '9' && digit - key < 9 + 18) {
+            value = value * 10 + (*digit - '0');
+            digit++;
+        }
+
+        if (digit == key + 9) {
+            key++;
+            continue;
+        } else if (digit < end && *digit >= '0' && *digit <= '9')
+            return TG_NULL;
+
+        *offset = (size_t)(key - string);
+
+        if (timestamp != NULL)
+            *timestamp = (time_t)value;
+
+        return TG_FOUND;
+    }
+
+    return TG_NOT_FOUND;
+}
+
+/**
+ * Get maximum number of bytes from string start to search datetime in
+ * Auto detected window is a multiple of the farthest datetime end seen so far
+ * Return 0 if whole string must be searched
+ */
+static size_t tg_window(const tg_parser* parser)
+{
+    if (parser->window_auto == 0)
+        return parser->window;
+    else if (parser->reach == 0)
+        return 0;
+    else if (parser->reach > TG_WINDOW_MIN / 4)
+        return parser->reach * 4;
+
+    return TG_WINDOW_MIN;
+}
+
+/**
+ * Execute datetime regular expression on string
+ * Return TG_FOUND on success, count is set to pcre_exec result
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_exec(
+    const tg_parser* parser,    /* datetime parser context                       */
+    const char*      string,    /* source string                                 */
+    int              length,    /* source string length                          */
+    int              offset,    /* position to start match                       */
+    int              options,   /* pcre_exec options                             */
+    int*             matches,   /* offset vector                                 */
+    int*             count      /* offset vector size / result of pcre_exec      */
+)
+{
+    int result;
+
+    result = pcre_exec(parser->re, parser->extra, string, length, offset, options, matches, *count);
+    if (result < 0) {
+        switch (result) {
+            case PCRE_ERROR_NOMATCH:
+            case PCRE_ERROR_BADUTF8:
+            case PCRE_ERROR_BADUTF8_OFFSET:
+#ifdef PCRE_ERROR_SHORTUTF8
+            case PCRE_ERROR_SHORTUTF8:
+#endif
+                return TG_NOT_FOUND;
+            case PCRE_ERROR_NOMEMORY:
                 errno = ENOMEM;
-            else {
+                break;
+            default:
                 errno = 0;
-                fprintf(stderr, gettext("%s pcre_get_substring error\n"), gettext("ERROR:"));
-            }
+                fprintf(stderr, gettext("%s pcre_exec error %i\n"), gettext("ERROR:"), result);
+        }
+
+        return TG_ERROR;
+    }
+
+    *count = result;
+
+    return TG_FOUND;
+}
+
+/**
+ * Find position after learned delimiter in string
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if string has no such delimiter
+ */
+static int tg_anchor_find(const tg_parser* parser, const char* string, size_t length, size_t* offset)
+{
+    size_t      nth;
+    const char* end;
+    const char* delim;
+
+    if (parser->delim == -1) {
+        *offset = 0;
+        return TG_FOUND;
+    }
+
+    end   = string + length;
+    delim = string;
+
+    for (nth = 0; nth < parser->delim_nth; nth++) {
+        delim = memchr(delim, parser->delim, (size_t)(end - delim));
+        if (delim == NULL)
+            return TG_NOT_FOUND;
+
+        delim++;
+    }
+
+    *offset = (size_t)(delim - string);
+
+    return TG_FOUND;
+}
+
+/**
+ * Learn delimiter before datetime found by whole string search
+ * Delimiter is the char before datetime and its occurrence number in string,
+ * so position of datetime does not depend on length of previous fields
+ */
+static void tg_anchor_learn(tg_parser* parser, const char* string, size_t offset)
+{
+    int         delim;
+    size_t      nth;
+    const char* end;
+
+    if (offset == 0) {
+        delim = -1;
+        nth   = 0;
+    } else {
+        delim = (unsigned char)string[offset - 1];
+        end   = string + offset;
+        nth   = 0;
+
+        while ((string = memchr(string, delim, (size_t)(end - string))) != NULL) {
+            nth++;
+            string++;
+        }
+    }
+
+    if (parser->delim == delim && parser->delim_nth == nth) {
+        if (parser->delim_hits < TG_ANCHOR_LEARN * 4)
+            parser->delim_hits++;
+    } else if (parser->delim_hits > 0)
+        parser->delim_hits--;
+    else {
+        parser->delim      = delim;
+        parser->delim_nth  = nth;
+        parser->delim_hits = 1;
+    }
+}
+
+/**
+ * Search, parse and convert datetime to timestamp from single string
+ * For order-preserving format datetime is not converted if it has fixed width,
+ * so stamp key points to datetime bytes in string (see tg_compare)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found, parse or convert error
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_get_timestamp(
+    const char*      string,     /* source string           */
+    size_t           length,     /* source string length    */
+    tg_parser*       parser,     /* datetime parser context */
+    tg_stamp*        stamp       /* result datetime         */
+)
+{
+    int         result;
+    int         count;
+    size_t      offset;
+    size_t      window;
+    const char* match;
+    int         matches[30];
+
+    stamp->key = NULL;
+
+    window = tg_window(parser);
+    if (window != 0 && length > window)
+        length = window;
+
+    if (parser->scan != NULL) {
+        result = parser->scan(string, length, &parser->civil, &offset, (parser->lexical == 0 ? &stamp->timestamp : NULL));
+        if (result == TG_FOUND) {
+            if (parser->anchor == TG_ANCHOR_START && offset != 0)
+                return TG_NOT_FOUND;
+            else if (parser->lexical != 0)
+                stamp->key = string + offset;
+
+            if (parser->reach < offset + TG_KEY_SIZE)
+                parser->reach = offset + TG_KEY_SIZE;
+        }
+
+        if (result != TG_NULL)
+            return result;
+    }
+
+    /* pcre_exec accept int as length */
+    if (length > (size_t)INT_MAX)
+        return TG_NOT_FOUND;
+
+    result = TG_NOT_FOUND;
+
+    if (parser->anchor == TG_ANCHOR_START) {
+        count  = sizeof(matches) / sizeof(int);
+        result = tg_exec(parser, string, (int)length, 0, PCRE_ANCHORED, matches, &count);
+        if (result != TG_FOUND)
+            return result;
+    } else if (parser->anchor == TG_ANCHOR_AUTO && parser->delim_hits >= TG_ANCHOR_LEARN && tg_anchor_find(parser, string, length, &offset) == TG_FOUND) {
+        count  = sizeof(matches) / sizeof(int);
+        result = tg_exec(parser, string, (int)length, (int)offset, PCRE_ANCHORED, matches, &count);
+        if (result == TG_ERROR)
+            return result;
+        else if (result == TG_FOUND && parser->delim_hits < TG_ANCHOR_LEARN * 4)
+            parser->delim_hits++;
+    }
+
+    if (result == TG_NOT_FOUND) {
+        count  = sizeof(matches) / sizeof(int);
+        result = tg_exec(parser, string, (int)length, 0, 0, matches, &count);
+        if (result != TG_FOUND)
+            return result;
+
+        if (parser->anchor == TG_ANCHOR_AUTO)
+            tg_anchor_learn(parser, string, (size_t)matches[0]);
+    }
+
+    if (parser->reach < (size_t)matches[1])
+        parser->reach = (size_t)matches[1];
+
+    if (parser->lexical != 0 && (size_t)(matches[1] - matches[0]) == parser->lexical) {
+        stamp->key = string + matches[0];
+        return TG_FOUND;
+    }
+
+    if (parser->fallback == 0)
+        result = tg_strptime_re(string, matches, count, &parser->nsi, &parser->civil, &stamp->timestamp);
+    else {
+        result = pcre_get_substring(string, matches, count, 0, &match);
+        if (result < 0) {
+            if (result == PCRE_ERROR_NOMEMORY)
+                errno = ENOMEM;
+            else {
+                errno = 0;
+                fprintf(stderr, gettext("%s pcre_get_substring error\n"), gettext("ERROR:"));
+            }
+
+            return TG_ERROR;
+        }
+
+        result = tg_strptime(match, parser->format, parser->format_tz, &parser->civil, &stamp->timestamp);
+
+        pcre_free_substring(match);
+    }
+
+    return result;
+}
+
+/**
+ * Compare datetime of string with search bound (timestamp and its rendered key)
+ * Return negative, zero or positive value if datetime is less, equal or greater than bound
+ */
+static int tg_compare(const tg_parser* parser, const tg_stamp* stamp, time_t timestamp, const char* key)
+{
+    if (stamp->key != NULL)
+        return memcmp(stamp->key, key, parser->lexical);
+
+    if (stamp->timestamp < timestamp)
+        return -1;
+    else if (stamp->timestamp > timestamp)
+        return 1;
+
+    return 0;
+}
+
+/**
+ * Convert datetime of string to timestamp (see tg_get_timestamp)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND on convert error
+ */
+static int tg_stamp_time(tg_parser* parser, const tg_stamp* stamp, time_t* timestamp)
+{
+    char buffer[TG_KEY_SIZE];
+
+    if (stamp->key == NULL) {
+        *timestamp = stamp->timestamp;
+        return TG_FOUND;
+    }
+
+    memcpy(buffer, stamp->key, parser->lexical);
+    buffer[parser->lexical] = 0;
+
+    return tg_strptime(buffer, parser->format, 0, &parser->civil, timestamp);
+}
+
+/**
+ * Skip NUL bytes (zero filled or sparse regions) forward from position up to size
+ * Return position of first not NUL byte or size
+ */
+static size_t tg_skip_nul(const char* data, size_t size, size_t position)
+{
+    const size_t* word;
+
+    while (position < size && data[position] == 0 && (uintptr_t)(data + position) % sizeof(size_t) != 0)
+        position++;
+
+    /* eight words at once */
+    while (position + 8 * sizeof(size_t) <= size && data[position] == 0) {
+        word = (const size_t*)(const void*)(data + position);
+        if ((word[0] | word[1] | word[2] | word[3] | word[4] | word[5] | word[6] | word[7]) != 0)
+            break;
+
+        position += 8 * sizeof(size_t);
+    }
+
+    while (position < size && data[position] == 0)
+        position++;
+
+    return position;
+}
+
+/**
+ * Skip NUL bytes backward from position (exclusive) down to lbound
+ * Return position next to last not NUL byte or lbound
+ */
+static size_t tg_rskip_nul(const char* data, size_t lbound, size_t position)
+{
+    const size_t* word;
+
+    while (position > lbound && data[position - 1] == 0 && (uintptr_t)(data + position) % sizeof(size_t) != 0)
+        position--;
+
+    while (position >= lbound + 8 * sizeof(size_t) && data[position - 1] == 0) {
+        word = (const size_t*)(const void*)(data + position - 8 * sizeof(size_t));
+        if ((word[0] | word[1] | word[2] | word[3] | word[4] | word[5] | word[6] | word[7]) != 0)
+            break;
+
+        position -= 8 * sizeof(size_t);
+    }
+
+    while (position > lbound && data[position - 1] == 0)
+        position--;
+
+    return position;
+}
+
+/**
+ * Search string start backward from position
+ * Both newline and NUL are string delimeters, so zero filled regions
+ * (copytruncate rotation) are not scanned past
+ * Return string start
+ */
+static size_t tg_get_string_start(const char* data, size_t position)
+{
+    char*  nl;
+    char*  nul;
+    size_t lower;
+
+    while (position > 0) {
+        lower = (position > TG_SCAN_BLOCK ? position - TG_SCAN_BLOCK : 0);
+
+        nl = memrchr(data + lower, '\n', position - lower);
+        if (nl != NULL)
+            lower = (size_t)(nl - data) + 1;
+
+        nul = memrchr(data + lower, 0, position - lower);
+        if (nul != NULL)
+            return (size_t)(nul - data) + 1;
+        else if (nl != NULL)
+            return lower;
+
+        position = lower;
+    }
+
+    return 0;
+}
+
+/**
+ * Search string stop forward from position up to limit (see tg_get_string_start)
+ * Return string delimeter position or NULL if not found
+ */
+static const char* tg_get_string_stop(const char* data, size_t position, size_t limit)
+{
+    char*  nl;
+    char*  nul;
+    size_t upper;
+
+    while (position < limit) {
+        upper = (limit - position > TG_SCAN_BLOCK ? position + TG_SCAN_BLOCK : limit);
+
+        nl = memchr(data + position, '\n', upper - position);
+        if (nl != NULL)
+            upper = (size_t)(nl - data);
+
+        nul = memchr(data + position, 0, upper - position);
+        if (nul != NULL)
+            return nul;
+        else if (nl != NULL)
+            return nl;
+
+        position = upper;
+    }
+
+    return NULL;
+}
+
+/**
+ * Search string boundaries in multiline data starting from position
+ * If window is not 0, string end is searched only within window bytes from string start
+ * and length is set to SIZE_MAX if string is longer (see tg_get_string_end)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if newline or NUL delimeter exactly in position
+ * Return TG_NULL if nothing found (whole data is single string without delimeter)
+ */
+static int tg_get_string(
+    const char* data,       /* multiline data                                 */
+    size_t      size,       /* size of multiline data                         */
+    size_t      position,   /* position to start search                       */
+    size_t      window,     /* bytes from string start to search end or 0     */
+    size_t*     start,      /* result string start                            */
+    size_t*     length      /* result string length (not including delimeter) */
+)
+{
+    const char* nl;
+    size_t      limit;
+
+    if (data[position] == '\n' || data[position] == 0)
+        return TG_NOT_FOUND;
+
+    *start = tg_get_string_start(data, position);
+
+    limit = size;
+    if (window != 0 && window < size - (*start))
+        limit = (*start) + window;
+
+    nl = tg_get_string_stop(data, position, limit);
+
+    if (nl != NULL)
+        *length = (size_t)(nl - data) - (*start);
+    else if (limit == size)
+        *length = size - (*start);
+    else
+        *length = SIZE_MAX;
+
+    if ((*length) == size)
+        return TG_NULL;
+
+    return TG_FOUND;
+}
+
+/**
+ * Search end of string which is longer than window (see tg_get_string)
+ * Return string length (not including delimeter)
+ */
+static size_t tg_get_string_end(const char* data, size_t size, size_t start)
+{
+    const char* nl;
+
+    nl = tg_get_string_stop(data, start, size);
+    if (nl == NULL)
+        return size - start;
+
+    return (size_t)(nl - data) - start;
+}
+
+/**
+ * Skip strings without datetime candidates starting from string at position up to ubound
+ * Datetime regular expression is matched over block of strings at once and only
+ * strings before first match are skipped, so string at result position still has
+ * to be checked with tg_get_timestamp. Block grows from TG_SCAN_BLOCK up to
+ * TG_BLOCK_SIZE as pcre_exec checks whole subject for valid UTF-8
+ * Return TG_FOUND and position of first string which may contain datetime
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_block_search(
+    const char*      data,       /* multiline data                        */
+    size_t           size,       /* size of multiline data                */
+    size_t           ubound,     /* upper bound position to search        */
+    const tg_parser* parser,     /* datetime parser context               */
+    size_t*          position    /* position to start search / result     */
+)
+{
+    int    result;
+    int    matches[3];
+    size_t start;
+    size_t limit;
+    size_t block;
+
+    block = TG_SCAN_BLOCK;
+    start = tg_get_string_start(data, *position);
+    limit = start;
+
+    while (start < ubound) {
+        if (limit == start) {
+            limit = start + block;
+            if (limit > ubound || limit < start)
+                limit = ubound;
+        }
+
+        result = pcre_exec(parser->re, parser->extra, data + start, (int)(limit - start), 0, 0, matches, 3);
+        if (result >= 0) {
+            *position = start + (size_t)matches[0];
+            return TG_FOUND;
+        }
+
+        switch (result) {
+            case PCRE_ERROR_NOMATCH:
+                if (limit == size) {
+                    *position = size;
+                    return TG_FOUND;
+                }
+
+                /* string crossing block end may contain datetime */
+                limit = tg_get_string_start(data, limit);
+                if (limit <= start)
+                    return TG_FOUND;
+
+                *position = limit;
+                if (limit == ubound)
+                    return TG_FOUND;
+
+                start = limit;
+                if (block < TG_BLOCK_SIZE)
+                    block *= 2;
+                break;
+            case PCRE_ERROR_BADUTF8:
+            case PCRE_ERROR_BADUTF8_OFFSET:
+#ifdef PCRE_ERROR_SHORTUTF8
+            case PCRE_ERROR_SHORTUTF8:
+#endif
+                /* search before invalid character */
+                limit = start + (size_t)matches[0];
+                if (limit == start)
+                    return TG_FOUND;
+                break;
+            case PCRE_ERROR_NOMEMORY:
+                errno = ENOMEM;
+                return TG_ERROR;
+            default:
+                errno = 0;
+                fprintf(stderr, gettext("%s pcre_exec error %i\n"), gettext("ERROR:"), result);
+                return TG_ERROR;
+        }
+    }
+
+    return TG_FOUND;
+}
+
+/**
+ * Forward search any timestamp in multiline data starting from position to ubound
+ * Result length is SIZE_MAX if only string prefix was scanned (see tg_get_string)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found from position to size
+ * Return TG_NULL if whole data is single string
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_forward_search(
+    const char*      data,       /* multiline data                                 */
+    size_t           size,       /* size of multiline data                         */
+    size_t           position,   /* position to start search                       */
+    size_t           ubound,     /* upper bound position to search                 */
+    tg_parser*       parser,     /* datetime parser context                        */
+    size_t*          start,      /* result string start                            */
+    size_t*          length,     /* result string length (not including delimeter) */
+    tg_stamp*        stamp       /* result datetime                                */
+)
+{
+    int      result;
+    int      block;
+    size_t   rstart;
+    size_t   rlength;
+    size_t   window;
+    tg_stamp rstamp;
+
+    block  = 0;
+    result = TG_NOT_FOUND;
+    while (result == TG_NOT_FOUND && position < ubound) {
+        /* strings without datetime in a row (multiline messages) */
+        if (block != 0 && tg_block_search(data, size, ubound, parser, &position) == TG_ERROR)
+            return TG_ERROR;
+        else if (position >= ubound)
+            break;
+
+        window = tg_window(parser);
+
+        result = tg_get_string(data, size, position, window, &rstart, &rlength);
+        if (result == TG_FOUND) {
+            result = tg_get_timestamp(data + rstart, (rlength == SIZE_MAX ? window : rlength), parser, &rstamp);
+            if (result == TG_NOT_FOUND) {
+                if (rlength == SIZE_MAX) {
+                    rlength = tg_get_string_end(data, size, rstart);
+                    if (rlength == size) {
+                        result = TG_NULL;
+                        break;
+                    }
+                }
+
+                position = rstart + rlength + 1;
+                block    = 1;
+            }
+        } else if (result == TG_NULL)
+            break;
+        else if (data[position] == 0) {
+            position = tg_skip_nul(data, ubound, position);
+            continue;
+        }
+
+        position++;
+    }
+
+    if (result == TG_FOUND) {
+        *start  = rstart;
+        *length = rlength;
+        *stamp  = rstamp;
+    }
+
+    return result;
+}
+
+/**
+ * Backward search any timestamp in multiline data from position down to lbound
+ * Result length is SIZE_MAX if only string prefix was scanned (see tg_get_string)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found from lbound to position
+ * Return TG_NULL if whole data is single string
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_backward_search(
+    const char*      data,       /* multiline data                                 */
+    size_t           size,       /* size of multiline data                         */
+    size_t           position,   /* position to start search (exclusive)           */
+    size_t           lbound,     /* lower bound position to search                 */
+    tg_parser*       parser,     /* datetime parser context                        */
+    size_t*          start,      /* result string start                            */
+    size_t*          length,     /* result string length (not including delimeter) */
+    tg_stamp*        stamp       /* result datetime                                */
+)
+{
+    int      result;
+    size_t   rstart;
+    size_t   rlength;
+    size_t   window;
+    tg_stamp rstamp;
+
+    result = TG_NOT_FOUND;
+    while (result == TG_NOT_FOUND && position > lbound) {
+        position--;
+        if (data[position] == '\n')
+            continue;
+        else if (data[position] == 0) {
+            position = tg_rskip_nul(data, lbound, position);
+            continue;
+        }
+
+        window = tg_window(parser);
+
+        result = tg_get_string(data, size, position, window, &rstart, &rlength);
+        if (result == TG_FOUND) {
+            if (rstart < lbound)
+                return TG_NOT_FOUND;
+
+            result   = tg_get_timestamp(data + rstart, (rlength == SIZE_MAX ? window : rlength), parser, &rstamp);
+            position = rstart;
+        }
+    }
+
+    if (result == TG_FOUND) {
+        *start  = rstart;
+        *length = rlength;
+        *stamp  = rstamp;
+    }
+
+    return result;
+}
+
+/**
+ * Record timestamped string seen by file search
+ */
+static void tg_probes_add(tg_probes* probes, size_t start, size_t length, const tg_stamp* stamp)
+{
+    tg_probe* probe;
+
+    if (probes == NULL || probes->count == TG_PROBES_SIZE)
+        return;
+
+    probe = probes->probe + probes->count;
+    probes->count++;
+
+    probe->start  = start;
+    probe->length = length;
+    probe->stamp  = *stamp;
+}
+
+/**
+ * Narrow search range [lbound, ubound) to tightest bracket of timestamp
+ * implied by recorded probes
+ */
+static void tg_probes_bracket(
+    const tg_probes* probes,    /* recorded probes                      */
+    const char*      data,      /* multiline data                       */
+    size_t           size,      /* size of multiline data               */
+    const tg_parser* parser,    /* datetime parser context              */
+    time_t           search,    /* timestamp to search                  */
+    const char*      key,       /* rendered timestamp to search         */
+    size_t*          lbound,    /* search range lower bound (inclusive) */
+    size_t*          ubound     /* search range upper bound (exclusive) */
+)
+{
+    size_t          i;
+    size_t          end;
+    const tg_probe* probe;
+
+    for (i = 0; i < probes->count; i++) {
+        probe = probes->probe + i;
+
+        if (tg_compare(parser, &probe->stamp, search, key) >= 0) {
+            if (probe->start < *ubound)
+                *ubound = probe->start;
+        } else {
+            end = probe->length;
+            if (end == SIZE_MAX)
+                end = tg_get_string_end(data, size, probe->start);
+
+            end += probe->start;
+            if (end + 1 > *lbound)
+                *lbound = end + 1;
+        }
+    }
+}
+
+/**
+ * Binary search timestamp in multiline data
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_binary_search(
+    const char*      data,      /* multiline data                            */
+    size_t           size,      /* size of multiline data                    */
+    tg_parser*       parser,    /* datetime parser context                   */
+    time_t           search,    /* timestamp to search                       */
+    const char*      key,       /* rendered timestamp to search              */
+    size_t           lbound,    /* recommended lower bound postion to search */
+    size_t*          position,  /* result string start                       */
+    tg_probes*       probes     /* probes to record or NULL                  */
+)
+{
+    int      retval;
+    int      result;
+    size_t   middle;
+    size_t   ubound;
+    tg_stamp stamp;
+    size_t   start;
+    size_t   length;
+
+    retval = TG_NOT_FOUND;
+    ubound = size;
+    middle = lbound + (ubound - lbound) / 2;
+
+    while (lbound != middle) {
+        result = tg_forward_search(
+            data,
+            size,
+            middle,
+            ubound,
+            parser,
+            &start,
+            &length,
+            &stamp
+        );
+
+        if (result == TG_FOUND) {
+            tg_probes_add(probes, start, length, &stamp);
+
+            if (tg_compare(parser, &stamp, search, key) < 0) {
+                if (length == SIZE_MAX)
+                    length = tg_get_string_end(data, size, start);
+
+                lbound = start + length;
+                middle = ubound;
+                if (lbound != ubound)
+                    lbound++;
+            } else {
+                retval    = TG_FOUND;
+                ubound    = start;
+                middle    = ubound;
+                *position = start;
+            }
+        } else if (result == TG_NOT_FOUND)
+            ubound = middle;
+        else if (result == TG_ERROR)
+            return TG_ERROR;
+        else
+            break;
+
+        middle = lbound + (middle - lbound) / 2;
+    }
+
+    return retval;
+}
+
+/**
+ * Interpolation search timestamp in multiline data
+ * Probe position is interpolated from timestamps at search bounds, so evenly
+ * growing logs take a few probes. Probe falls back to halving after
+ * interpolation which did not shrink search range at least twice
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_interpolation_search(
+    const char*      data,      /* multiline data                            */
+    size_t           size,      /* size of multiline data                    */
+    tg_parser*       parser,    /* datetime parser context                   */
+    time_t           search,    /* timestamp to search                       */
+    const char*      key,       /* rendered timestamp to search              */
+    size_t           lbound,    /* recommended lower bound postion to search */
+    size_t*          position,  /* result string start                       */
+    tg_probes*       probes     /* probes to record or NULL                  */
+)
+{
+    int      result;
+    int      bisect;
+    size_t   middle;
+    size_t   ubound;
+    size_t   range;
+    time_t   ltime;
+    time_t   utime;
+    tg_stamp stamp;
+    size_t   start;
+    size_t   length;
+
+    /* last timestamp is upper bound */
+    result = tg_backward_search(data, size, size, lbound, parser, &start, &length, &stamp);
+    if (result == TG_ERROR)
+        return TG_ERROR;
+    else if (result != TG_FOUND)
+        return TG_NOT_FOUND;
+
+    tg_probes_add(probes, start, length, &stamp);
+
+    if (tg_compare(parser, &stamp, search, key) < 0)
+        return TG_NOT_FOUND;
+
+    ubound    = start;
+    *position = start;
+
+    if (tg_stamp_time(parser, &stamp, &utime) != TG_FOUND)
+        utime = search;
+
+    /* first timestamp is lower bound */
+    result = tg_forward_search(data, size, lbound, ubound, parser, &start, &length, &stamp);
+    if (result == TG_ERROR)
+        return TG_ERROR;
+    else if (result != TG_FOUND)
+        return TG_FOUND;
+
+    tg_probes_add(probes, start, length, &stamp);
+
+    if (tg_compare(parser, &stamp, search, key) >= 0) {
+        *position = start;
+        return TG_FOUND;
+    }
+
+    if (length == SIZE_MAX)
+        length = tg_get_string_end(data, size, start);
+
+    lbound = start + length + 1;
+
+    if (tg_stamp_time(parser, &stamp, &ltime) != TG_FOUND)
+        ltime = search;
+
+    bisect = 0;
+    while (lbound < ubound) {
+        range = ubound - lbound;
+
+        if (bisect != 0 || ltime >= search || utime <= ltime)
+            middle = lbound + range / 2;
+        else {
+            middle = lbound + (size_t)((double)range * (double)(search - ltime) / (double)(utime - ltime));
+            if (middle >= ubound)
+                middle = ubound - 1;
+        }
+
+        result = tg_forward_search(
+            data,
+            size,
+            middle,
+            ubound,
+            parser,
+            &start,
+            &length,
+            &stamp
+        );
+
+        if (result == TG_FOUND) {
+            tg_probes_add(probes, start, length, &stamp);
+
+            if (tg_compare(parser, &stamp, search, key) < 0) {
+                if (length == SIZE_MAX)
+                    length = tg_get_string_end(data, size, start);
+
+                lbound = start + length + 1;
+
+                if (tg_stamp_time(parser, &stamp, &ltime) != TG_FOUND)
+                    ltime = search;
+            } else {
+                ubound    = start;
+                *position = start;
+
+                if (tg_stamp_time(parser, &stamp, &utime) != TG_FOUND)
+                    utime = search;
+            }
+        } else if (result == TG_NOT_FOUND)
+            ubound = middle;
+        else if (result == TG_ERROR)
+            return TG_ERROR;
+        else
+            break;
+
+        bisect = (bisect == 0 && lbound < ubound && ubound - lbound > range / 2);
+    }
+
+    return TG_FOUND;
+}
+
+/**
+ * Galloping search timestamp in multiline data from end of data
+ * Probe steps back from end of data doubling on every probe until timestamp
+ * is bracketed, so recent timestamps touch only pages near end of data.
+ * Bracket is searched with tg_interpolation_search
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_tail_search(
+    const char*      data,      /* multiline data                            */
+    size_t           size,      /* size of multiline data                    */
+    tg_parser*       parser,    /* datetime parser context                   */
+    time_t           search,    /* timestamp to search                       */
+    const char*      key,       /* rendered timestamp to search              */
+    size_t           lbound,    /* recommended lower bound postion to search */
+    size_t*          position,  /* result string start                       */
+    tg_probes*       probes     /* probes to record or NULL                  */
+)
+{
+    int      result;
+    int      retval;
+    size_t   middle;
+    size_t   ubound;
+    size_t   step;
+    tg_stamp stamp;
+    size_t   start;
+    size_t   length;
+
+    retval = TG_NOT_FOUND;
+    ubound = size;
+    step   = TG_GALLOP_SIZE;
+
+    while (lbound < ubound) {
+        if (ubound - lbound > step)
+            middle = ubound - step;
+        else
+            middle = lbound;
+
+        result = tg_forward_search(
+            data,
+            size,
+            middle,
+            ubound,
+            parser,
+            &start,
+            &length,
+            &stamp
+        );
+
+        if (result == TG_FOUND) {
+            tg_probes_add(probes, start, length, &stamp);
+
+            if (tg_compare(parser, &stamp, search, key) < 0) {
+                if (length == SIZE_MAX)
+                    length = tg_get_string_end(data, size, start);
+
+                lbound = start + length + 1;
+                break;
+            }
+
+            ubound    = start;
+            *position = start;
+            retval    = TG_FOUND;
+        } else if (result == TG_NOT_FOUND)
+            ubound = middle;
+        else if (result == TG_ERROR)
+            return TG_ERROR;
+        else
+            break;
+
+        /* no strings left before found one */
+        if (middle == lbound)
+            return retval;
+
+        if (step <= SIZE_MAX / 2)
+            step *= 2;
+    }
+
+    if (lbound >= ubound)
+        return retval;
+
+    /* data from ubound is already known to be not less than search */
+    result = tg_interpolation_search(data, ubound, parser, search, key, lbound, &start, probes);
+    if (result == TG_FOUND)
+        *position = start;
+    else if (result == TG_ERROR)
+        return TG_ERROR;
+    else
+        return retval;
+
+    return TG_FOUND;
+}
+
+/**
+ * Size of leading sparse hole of file (copytruncate rotation)
+ * Return 0 if there is no hole or SEEK_DATA is not supported
+ */
+static size_t tg_file_hole(int fd, size_t size)
+{
+#ifdef SEEK_DATA
+    off_t offset;
+
+    offset = lseek(fd, 0, SEEK_DATA);
+    if (offset == -1) {
+        /* ENXIO - whole file is hole */
+        if (errno == ENXIO)
+            return size;
+
+        return 0;
+    }
+
+    return ((size_t)offset < size ? (size_t)offset : size);
+#else
+    (void)fd;
+    (void)size;
+
+    return 0;
+#endif
+}
+
+/**
+ * Write whole buffer to file descriptor
+ * Return TG_FOUND on success
+ * Return TG_ERROR on error, errno is set
+ */
+static int tg_write(int fd, const void* data, size_t size)
+{
+    ssize_t     actual;
+    const char* buffer = data;
+
+    while (size != 0) {
+        actual = write(fd, buffer, size);
+        if (actual == -1) {
+            if (errno == EINTR)
+                continue;
+
+            return TG_ERROR;
+        }
+
+        buffer += actual;
+        size   -= (size_t)actual;
+    }
+
+    return TG_FOUND;
+}
+
+/**
+ * Hash of datetime format to validate sparse index (FNV-1a)
+ */
+static uint64_t tg_index_format(const char* format)
+{
+    uint32_t hash = 2166136261UL;
+
+    while (*format != 0) {
+        hash ^= (unsigned char)*format;
+        hash *= 16777619UL;
+        format++;
+    }
+
+    return hash;
+}
+
+/**
+ * Fill sparse index header for file
+ */
+static void tg_index_header_init(const tg_context* ctx, const struct stat* file_stat, tg_index_header* header)
+{
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, TG_INDEX_MAGIC, sizeof(header->magic));
+
+    header->ino      = (uint64_t)file_stat->st_ino;
+    header->size     = (uint64_t)file_stat->st_size;
+    header->mtime    = (int64_t)file_stat->st_mtime;
+    header->format   = tg_index_format(ctx->parser.format);
+    header->timezone = (int64_t)TG_TIMEZONE;
+}
+
+/**
+ * Allocate filename with suffix
+ * Return NULL on error, errno is set
+ */
+static char* tg_filename(const char* filename, const char* suffix)
+{
+    char*  result;
+    size_t length;
+
+    length = strlen(filename);
+
+    result = malloc(length + strlen(suffix) + 1);
+    if (result == NULL)
+        return NULL;
+
+    memcpy(result, filename, length);
+    strcpy(result + length, suffix);
+
+    return result;
+}
+
+/**
+ * Replace file content atomically (write temporary file, sync and rename)
+ * Return TG_FOUND on success
+ * Return TG_ERROR on error, errno is set
+ */
+static int tg_replace_file(const char* filename, const void* head, size_t head_size, const void* body, size_t body_size)
+{
+    int   fd;
+    int   error;
+    int   result;
+    char* tempname;
+
+    tempname = tg_filename(filename, ".XXXXXX");
+    if (tempname == NULL)
+        return TG_ERROR;
+
+    fd = mkstemp(tempname);
+    if (fd == -1) {
+        free(tempname);
+        return TG_ERROR;
+    }
+
+    result = TG_ERROR;
+    if (
+        fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != -1 &&
+        tg_write(fd, head, head_size) == TG_FOUND &&
+        tg_write(fd, body, body_size) == TG_FOUND &&
+        fsync(fd) != -1
+    )
+        result = TG_FOUND;
+
+    if (close(fd) == -1)
+        result = TG_ERROR;
+
+    if (result == TG_FOUND && rename(tempname, filename) == -1)
+        result = TG_ERROR;
+
+    if (result == TG_ERROR) {
+        error = errno;
+        unlink(tempname);
+        errno = error;
+    }
+
+    free(tempname);
+
+    return result;
+}
+
+/**
+ * Build sparse index of mapped file to <filename>.tgidx
+ * Index holds first timestamped string after every TG_INDEX_STEP bytes and
+ * is replaced atomically
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_file_index(tg_context* ctx, const struct stat* file_stat)
+{
+    int             result;
+    size_t          position;
+    size_t          start;
+    size_t          length;
+    size_t          count;
+    size_t          alloc;
+    time_t          timestamp;
+    tg_stamp        stamp;
+    tg_index_entry* entries;
+    tg_index_entry* realloc_entries;
+    tg_index_header header;
+    char*           filename;
+
+    entries  = NULL;
+    filename = NULL;
+    count    = 0;
+    alloc    = 0;
+    result   = TG_ERROR;
+
+    position = ctx->hole;
+    while (position < ctx->size) {
+        result = tg_forward_search(ctx->data, ctx->size, position, ctx->size, &ctx->parser, &start, &length, &stamp);
+        if (result == TG_ERROR)
+            goto ERROR;
+        else if (result != TG_FOUND)
+            break;
+
+        if (tg_stamp_time(&ctx->parser, &stamp, &timestamp) == TG_FOUND && (count == 0 || entries[count - 1].offset != start)) {
+            if (count == alloc) {
+                alloc = (alloc == 0 ? 1024 : alloc * 2);
+
+                realloc_entries = realloc(entries, alloc * sizeof(tg_index_entry));
+                if (realloc_entries == NULL)
+                    goto ERROR;
+
+                entries = realloc_entries;
+            }
+
+            entries[count].offset    = (uint64_t)start;
+            entries[count].timestamp = (int64_t)timestamp;
+            count++;
+        }
+
+        /* string may start before position */
+        if (start > position)
+            position = start;
+
+        position = position - position % TG_INDEX_STEP + TG_INDEX_STEP;
+    }
+
+    tg_index_header_init(ctx, file_stat, &header);
+    header.step  = TG_INDEX_STEP;
+    header.count = count;
+
+    filename = tg_filename(ctx->filename, TG_INDEX_SUFFIX);
+    if (filename == NULL)
+        goto ERROR;
+
+    if (tg_replace_file(filename, &header, sizeof(header), entries, count * sizeof(tg_index_entry)) == TG_ERROR)
+        goto ERROR;
+
+    result = TG_FOUND;
+
+    goto SUCCESS;
+
+ERROR:
+
+    result = TG_ERROR;
+
+SUCCESS:
+
+    free(entries);
+    free(filename);
+
+    return result;
+}
+
+/**
+ * Map index of file with magic, header and entry sizes if it exists and is valid
+ * for file and datetime format
+ */
+static void tg_index_map(tg_context* ctx, const struct stat* file_stat, const char* magic, size_t header_size, size_t entry_size)
+{
+    int             fd;
+    char*           filename;
+    struct stat     index_stat;
+    tg_index_header header;
+    tg_index_header expect;
+
+    filename = tg_filename(ctx->filename, TG_INDEX_SUFFIX);
+    if (filename == NULL)
+        return;
+
+    fd = open(filename, O_RDONLY);
+    free(filename);
+
+    if (fd == -1)
+        return;
+
+    if (fstat(fd, &index_stat) == -1 || (size_t)index_stat.st_size < header_size) {
+        close(fd);
+        return;
+    }
+
+    ctx->index_size = (size_t)index_stat.st_size;
+    ctx->index_data = mmap(NULL, ctx->index_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (ctx->index_data == MAP_FAILED)
+        return;
+
+    memcpy(&header, ctx->index_data, sizeof(header));
+
+    tg_index_header_init(ctx, file_stat, &expect);
+    memcpy(expect.magic, magic, sizeof(expect.magic));
+    expect.step  = header.step;
+    expect.count = header.count;
+
+    if (
+        memcmp(&header, &expect, sizeof(header)) != 0 ||
+        header.step == 0 ||
+        header.count != (ctx->index_size - header_size) / entry_size ||
+        (ctx->index_size - header_size) % entry_size != 0
+    ) {
+        munmap(ctx->index_data, ctx->index_size);
+        ctx->index_data = MAP_FAILED;
+    }
+}
+
+/**
+ * Map sparse index of file if it exists and is valid for file and datetime format
+ */
+static void tg_index_open(tg_context* ctx, const struct stat* file_stat)
+{
+    tg_index_map(ctx, file_stat, TG_INDEX_MAGIC, sizeof(tg_index_header), sizeof(tg_index_entry));
+}
+
+/**
+ * Unmap index mapped with tg_index_map
+ */
+static void tg_index_close(tg_context* ctx)
+{
+    if (ctx->index_data != MAP_FAILED) {
+        munmap(ctx->index_data, ctx->index_size);
+        ctx->index_data = MAP_FAILED;
+    }
+}
+
+/**
+ * Narrow search range [lbound, ubound) of timestamp with sparse index
+ */
+static void tg_index_bracket(const tg_context* ctx, time_t search, size_t* lbound, size_t* ubound)
+{
+    size_t                lower;
+    size_t                upper;
+    size_t                middle;
+    size_t                count;
+    const tg_index_entry* entries;
+
+    if (ctx->index_data == MAP_FAILED)
+        return;
+
+    count   = (ctx->index_size - sizeof(tg_index_header)) / sizeof(tg_index_entry);
+    entries = (const tg_index_entry*)(const void*)(ctx->index_data + sizeof(tg_index_header));
+
+    /* first entry not less than search */
+    lower = 0;
+    upper = count;
+    while (lower < upper) {
+        middle = lower + (upper - lower) / 2;
+        if (entries[middle].timestamp < (int64_t)search)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+
+    if (lower != 0 && entries[lower - 1].offset > *lbound)
+        *lbound = (size_t)entries[lower - 1].offset;
+
+    if (lower != count && entries[lower].offset < *ubound)
+        *ubound = (size_t)entries[lower].offset;
+}
+
+/**
+ * Read function of file descriptor for tg_reader
+ */
+static ssize_t tg_read_fd(void* source, char* buffer, size_t size)
+{
+    return read(*(const int*)source, buffer, size);
+}
+
+/**
+ * Read string from stream and dynamically (re)allocate frame data if needed
+ * String longer than max (if not 0) is returned by parts of max bytes, so frame size is
+ * bounded, part is not followed by '\n' in frame if string is continued (see tg_string_continued)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND on EOF
+ * Retrun TG_ERROR on error, errno is set on system error
+ */
+static int tg_read_stream_string(
+    const tg_reader* reader,   /* stream data source              */
+    size_t           chunk,    /* io / memory chunk size          */
+    size_t           max,      /* maximum string length or 0      */
+    char**           data,     /* frame data (may be reallocated) */
+    size_t*          size,     /* frame size (may be resized)     */
+    size_t           lbound,   /* lower bound frame position      */
+    size_t*          ubound,   /* upper bound frame position      */
+    size_t*          length    /* found string length             */
+)
+{
+    char*   nl;
+    char*   buffer;
+    ssize_t actual;
+    size_t  position;
+
+    /* string part is max bytes not followed by '\n' */
+    if (max != 0 && (*ubound) - lbound > max) {
+        nl = memchr((*data) + lbound, '\n', max + 1);
+
+        *length = (nl == NULL ? max : (size_t)(nl - (*data)) - lbound);
+        return TG_FOUND;
+    }
+
+    nl = memchr((*data) + lbound, '\n', (*ubound) - lbound);
+    if (nl != NULL) {
+        *length = (size_t)(nl - (*data)) - lbound;
+        return TG_FOUND;
+    }
+
+    while (1) {
+        if ((*size) - (*ubound) < chunk) {
+            buffer = realloc(*data, (*size) + chunk * 2);
+            if (buffer == NULL)
+                return TG_ERROR;
+
+            *data  = buffer;
+            *size += chunk * 2;
+        }
+
+        actual = reader->read(reader->source, (*data) + (*ubound), chunk);
+        if (actual == -1)
+            return TG_ERROR;
+        else if (actual == 0)
+            return TG_NOT_FOUND;
+
+        position = *ubound;
+        *ubound += (size_t)actual;
+
+        if (max != 0 && (*ubound) - lbound > max) {
+            nl = memchr((*data) + position, '\n', lbound + max + 1 - position);
+
+            *length = (nl == NULL ? max : (size_t)(nl - (*data)) - lbound);
+            break;
+        }
+
+        nl = memchr((*data) + position, '\n', (size_t)actual);
+        if (nl != NULL) {
+            *length = (size_t)(nl - (*data)) - lbound;
+            break;
+        }
+    }
+
+    return TG_FOUND;
+}
+
+/**
+ * Check string part found by tg_read_stream_string is continued by next part
+ */
+static int tg_string_continued(const char* data, size_t lbound, size_t length)
+{
+    return (data[lbound + length] != '\n');
+}
+
+/**
+ * Print strings of stream from first string not less than start to first string not less than stop
+ * If skip is set first string is skipped (stream starts inside string), if whole is set
+ * all strings after start are printed without datetime parse. Stream is assumed monotone:
+ * only last datetime of complete strings of read chunk is parsed, chunk is skipped at once
+ * while it is less than start and printed at once while it is less than stop, so only
+ * chunks with start and stop are parsed by string
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_stream_filter(tg_context* ctx, const tg_reader* reader, int skip, int whole)
+{
+    int      result;
+    ssize_t  actual;
+    size_t   length;
+    size_t   start;
+    tg_stamp stamp;
+    char*    nl;
+    char*    data     = NULL;
+    size_t   size     = 0;
+    size_t   lbound   = 0;
+    size_t   ubound   = 0;
+    size_t   complete = 0;
+    int      stream   = 0;
+    int      part     = 0;
+    int      continued;
+
+    while (1) {
+        result = tg_read_stream_string(reader, ctx->chunk, ctx->max_line, &data, &size, lbound, &ubound, &length);
+        if (result == TG_ERROR)
+            goto ERROR;
+        else if (result == TG_NOT_FOUND) {
+            /* incomplete string at end of stream is dropped unless it is printed long string */
+            if (part != 0 && stream == 1 && tg_write(STDOUT_FILENO, data + lbound, ubound - lbound) == TG_ERROR)
+                goto ERROR;
+
+            break;
+        }
+
+        /* parts of long string after first are printed or skipped with it */
+        continued = part;
+        part      = tg_string_continued(data, lbound, length);
+
+        if (skip != 0) {
+            skip    = part;
+            lbound += length + 1;
+            continue;
+        }
+
+        if (stream == 1 && whole != 0) {
+            /* rest of stream as is */
+            do {
+                if (tg_write(STDOUT_FILENO, data + lbound, ubound - lbound) == TG_ERROR)
+                    goto ERROR;
+
+                lbound = 0;
+                ubound = 0;
+
+                actual = reader->read(reader->source, data, size);
+                if (actual == -1)
+                    goto ERROR;
+
+                ubound = (size_t)actual;
+            } while (ubound != 0);
+
+            break;
+        }
+
+        result = TG_NOT_FOUND;
+        if (continued == 0)
+            result = tg_get_timestamp(data + lbound, length, &ctx->parser, &stamp);
+
+        if (result == TG_ERROR)
+            goto ERROR;
+
+        if (result == TG_FOUND) {
+            if (tg_compare(&ctx->parser, &stamp, ctx->stop, ctx->stop_key) >= 0 && whole == 0)
+                break;
+            else if (stream == 0 && tg_compare(&ctx->parser, &stamp, ctx->start, ctx->start_key) >= 0)
+                stream = 1;
+        }
+
+        if (stream == 1) {
+            length++;
+
+            while (length > 0) {
+                actual = write(STDOUT_FILENO, data + lbound, length);
+                if (actual == -1)
+                    goto ERROR;
+
+                length -= (size_t)actual;
+                lbound += (size_t)actual;
+            }
+        } else
+            lbound += length + 1;
+
+        /* complete strings of chunk are checked once (chunk with start or stop is parsed by string) */
+        if (lbound >= complete && (stream == 0 || whole == 0)) {
+            nl       = memrchr(data + lbound, '\n', ubound - lbound);
+            complete = (nl == NULL ? lbound : (size_t)(nl - data) + 1);
+
+            /* rest of long string is not parsed */
+            start = lbound;
+            if (part != 0 && complete > lbound)
+                start = (size_t)((char*)memchr(data + lbound, '\n', complete - lbound) - data) + 1;
+
+            result = TG_NULL;
+            if (complete > lbound)
+                result = tg_backward_search(data, complete, complete, start, &ctx->parser, &start, &length, &stamp);
+
+            if (result == TG_ERROR)
+                goto ERROR;
+            else if (result == TG_NOT_FOUND || result == TG_FOUND) {
+                if (stream == 0 && (result == TG_NOT_FOUND || tg_compare(&ctx->parser, &stamp, ctx->start, ctx->start_key) < 0)) {
+                    lbound = complete;
+                    part   = 0;
+                } else if (stream == 1 && (result == TG_NOT_FOUND || tg_compare(&ctx->parser, &stamp, ctx->stop, ctx->stop_key) < 0)) {
+                    if (tg_write(STDOUT_FILENO, data + lbound, complete - lbound) == TG_ERROR)
+                        goto ERROR;
+
+                    lbound = complete;
+                    part   = 0;
+                }
+            }
+        }
+
+        if (ubound - lbound < lbound) {
+            memmove(data, data + lbound, ubound - lbound);
+
+            complete = (complete > lbound ? complete - lbound : 0);
+            ubound   = ubound - lbound;
+            lbound   = 0;
+        }
+    }
+
+    free(data);
+
+    return (stream == 1 ? TG_FOUND : TG_NOT_FOUND);
+
+ERROR:
+
+    result = errno;
+
+    free(data);
+
+    errno = result;
+
+    return TG_ERROR;
+}
+
+#if defined(TG_WITH_ZLIB) || defined(TG_WITH_ZSTD) || defined(TG_WITH_LZMA)
+
+/**
+ * Search first timestamp in stream of reader
+ * Stream may start inside string, so first string is skipped if skip is set
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if stream has no timestamps
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_reader_first(tg_context* ctx, const tg_reader* reader, int skip, time_t* timestamp)
+{
+    int      result;
+    int      part;
+    size_t   length;
+    tg_stamp stamp;
+    char*    data   = NULL;
+    size_t   size   = 0;
+    size_t   lbound = 0;
+    size_t   ubound = 0;
+
+    while (1) {
+        result = tg_read_stream_string(reader, ctx->chunk, ctx->max_line, &data, &size, lbound, &ubound, &length);
+        if (result != TG_FOUND)
+            break;
+
+        part = tg_string_continued(data, lbound, length);
+
+        if (skip == 0) {
+            result = tg_get_timestamp(data + lbound, length, &ctx->parser, &stamp);
+            if (result == TG_ERROR || (result == TG_FOUND && (result = tg_stamp_time(&ctx->parser, &stamp, timestamp)) == TG_FOUND))
+                break;
+        }
+
+        /* parts of long string after first are not parsed */
+        skip    = part;
+        lbound += length + 1;
+        if (ubound - lbound < lbound) {
+            memmove(data, data + lbound, ubound - lbound);
+
+            ubound = ubound - lbound;
+            lbound = 0;
+        }
+    }
+
+    length = (size_t)errno;
+    free(data);
+    errno = (int)length;
+
+    return result;
+}
+
+/**
+ * Search last timestamp in stream of reader (stream is read to memory)
+ * Stream may start inside string, so first string is skipped if skip is set
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if stream has no timestamps
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_reader_last(tg_context* ctx, const tg_reader* reader, int skip, time_t* timestamp)
+{
+    int      result;
+    ssize_t  actual;
+    size_t   lbound;
+    size_t   start;
+    size_t   length;
+    tg_stamp stamp;
+    char*    buffer;
+    char*    data = NULL;
+    size_t   size = 0;
+    size_t   used = 0;
+
+    result = TG_ERROR;
+    while (1) {
+        if (size - used < ctx->chunk) {
+            buffer = realloc(data, size + ctx->chunk * 2);
+            if (buffer == NULL)
+                goto ERROR;
+
+            data  = buffer;
+            size += ctx->chunk * 2;
+        }
+
+        actual = reader->read(reader->source, data + used, size - used);
+        if (actual == -1)
+            goto ERROR;
+        else if (actual == 0)
+            break;
+
+        used += (size_t)actual;
+    }
+
+    lbound = 0;
+    if (skip != 0) {
+        buffer = memchr(data, '\n', used);
+        lbound = (buffer == NULL ? used : (size_t)(buffer - data) + 1);
+    }
+
+    result = TG_NOT_FOUND;
+    if (lbound < used)
+        result = tg_backward_search(data, used, used, lbound, &ctx->parser, &start, &length, &stamp);
+
+    if (result == TG_FOUND)
+        result = tg_stamp_time(&ctx->parser, &stamp, timestamp);
+    else if (result == TG_NULL)
+        result = TG_NOT_FOUND;
+
+ERROR:
+
+    length = (size_t)errno;
+    free(data);
+    errno = (int)length;
+
+    return result;
+}
+
+#endif
+
+/**
+ * Compressed format of mapped file by magic
+ * Return TG_COMPRESSED_NONE if file is plain text or format is not supported
+ */
+static int tg_file_compressed(const tg_context* ctx)
+{
+#ifdef TG_WITH_ZLIB
+    if (ctx->size >= 2 && (unsigned char)ctx->data[0] == 0x1f && (unsigned char)ctx->data[1] == 0x8b)
+        return TG_COMPRESSED_GZIP;
+#endif
+#ifdef TG_WITH_ZSTD
+    if (
+        ctx->size >= 4 &&
+        (unsigned char)ctx->data[0] == (TG_ZSTD_MAGIC & 0xFF) &&
+        (unsigned char)ctx->data[1] == ((TG_ZSTD_MAGIC >> 8) & 0xFF) &&
+        (unsigned char)ctx->data[2] == ((TG_ZSTD_MAGIC >> 16) & 0xFF) &&
+        (unsigned char)ctx->data[3] == ((TG_ZSTD_MAGIC >> 24) & 0xFF)
+    )
+        return TG_COMPRESSED_ZSTD;
+#endif
+#ifdef TG_WITH_LZMA
+    if (ctx->size >= 6 && memcmp(ctx->data, TG_XZ_MAGIC, 6) == 0)
+        return TG_COMPRESSED_XZ;
+#endif
+
+    (void)ctx;
+
+    return TG_COMPRESSED_NONE;
+}
+
+#ifdef TG_WITH_ZLIB
+
+/**
+ * gzip checkpoint - deflate block start to resume inflate from (see tg_gzip_index)
+ * Checkpoint with zero compressed offset is start of file
+ */
+typedef struct {
+    uint64_t      offset;       /* uncompressed offset                        */
+    uint64_t      coffset;      /* compressed offset of deflate block         */
+    int64_t       timestamp;    /* first timestamp after offset or INT64_MAX  */
+    uint32_t      bits;         /* bits of deflate block in previous byte     */
+    uint32_t      length;       /* window length                              */
+    unsigned char window[TG_GZIP_WINDOW];   /* uncompressed data before block */
+} tg_gzip_point;
+
+/**
+ * gzip checkpoint index file header
+ */
+typedef struct {
+    tg_index_header index;      /* header with TG_GZIP_MAGIC, step is span    */
+    int64_t         last;       /* last timestamp of file or INT64_MAX        */
+} tg_gzip_header;
+
+/**
+ * gzip reader of mapped file for tg_reader
+ */
+typedef struct {
+    const unsigned char* data;     /* mapped compressed file                  */
+    size_t               size;     /* size of compressed file                 */
+    z_stream             stream;   /* inflate state                           */
+    int                  raw;      /* raw deflate resumed from checkpoint     */
+    int                  end;      /* end of last gzip member                 */
+    uint64_t             offset;   /* uncompressed offset of next byte        */
+    uint64_t             span;     /* bytes between checkpoints to record     */
+    tg_gzip_point*       points;   /* recorded checkpoints                    */
+    size_t               count;    /* number of recorded checkpoints          */
+    size_t               alloc;    /* allocated checkpoints                   */
+} tg_gzip;
+
+/**
+ * Start inflate of mapped file from checkpoint or from file start if point is NULL
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_gzip_open(tg_gzip* gzip, const char* data, size_t size, const tg_gzip_point* point)
+{
+    int result;
+
+    memset(gzip, 0, sizeof(*gzip));
+
+    gzip->data = (const unsigned char*)data;
+    gzip->size = size;
+
+    if (point == NULL || point->coffset == 0) {
+        result = inflateInit2(&gzip->stream, 15 + 16);
+        gzip->stream.next_in = (Bytef*)gzip->data;
+    } else {
+        gzip->raw    = 1;
+        gzip->offset = point->offset;
+
+        result = inflateInit2(&gzip->stream, -15);
+        gzip->stream.next_in = (Bytef*)(gzip->data + point->coffset);
+
+        if (result == Z_OK && point->bits != 0)
+            result = inflatePrime(&gzip->stream, (int)point->bits, gzip->data[point->coffset - 1] >> (8 - point->bits));
+
+        if (result == Z_OK)
+            result = inflateSetDictionary(&gzip->stream, point->window, point->length);
+    }
+
+    if (result != Z_OK) {
+        errno = (result == Z_MEM_ERROR ? ENOMEM : EBADMSG);
+        return TG_ERROR;
+    }
+
+    return TG_FOUND;
+}
+
+/**
+ * Free inflate state and recorded checkpoints
+ */
+static void tg_gzip_close(tg_gzip* gzip)
+{
+    inflateEnd(&gzip->stream);
+    free(gzip->points);
+
+    gzip->points = NULL;
+    gzip->count  = 0;
+    gzip->alloc  = 0;
+}
+
+/**
+ * Record checkpoint at current inflate position
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_gzip_mark(tg_gzip* gzip, uint64_t offset)
+{
+    uInt           length;
+    tg_gzip_point* points;
+    tg_gzip_point* point;
+
+    if (gzip->count == gzip->alloc) {
+        gzip->alloc = (gzip->alloc == 0 ? 64 : gzip->alloc * 2);
+
+        points = realloc(gzip->points, gzip->alloc * sizeof(tg_gzip_point));
+        if (points == NULL)
+            return TG_ERROR;
+
+        gzip->points = points;
+    }
+
+    point = gzip->points + gzip->count;
+    memset(point, 0, sizeof(*point));
+
+    point->offset    = offset;
+    point->timestamp = INT64_MAX;
+
+    /* start of file or deflate block */
+    if (offset != 0) {
+        length = TG_GZIP_WINDOW;
+        if (inflateGetDictionary(&gzip->stream, point->window, &length) != Z_OK) {
+            errno = EBADMSG;
+            return TG_ERROR;
+        }
+
+        point->coffset = (uint64_t)(gzip->stream.next_in - gzip->data);
+        point->bits    = (uint32_t)(gzip->stream.data_type & 7);
+        point->length  = (uint32_t)length;
+    }
+
+    gzip->count++;
+
+    return TG_FOUND;
+}
+
+/**
+ * Read function of gzip reader for tg_reader
+ * Concatenated gzip members are read as single stream, checkpoints are recorded
+ * at deflate block boundaries every span bytes if span is set
+ */
+static ssize_t tg_gzip_read(void* source, char* buffer, size_t size)
+{
+    int       result;
+    size_t    position;
+    uint64_t  offset;
+    tg_gzip*  gzip   = source;
+    z_stream* stream = &gzip->stream;
+
+    if (size > UINT_MAX)
+        size = UINT_MAX;
+
+    stream->next_out  = (Bytef*)buffer;
+    stream->avail_out = (uInt)size;
+
+    while (stream->avail_out == size && gzip->end == 0) {
+        position = (size_t)(stream->next_in - gzip->data);
+        if (stream->avail_in == 0) {
+            if (position >= gzip->size) {
+                errno = EBADMSG;
+                return -1;
+            }
+
+            stream->avail_in = (uInt)(gzip->size - position < TG_GZIP_INPUT ? gzip->size - position : TG_GZIP_INPUT);
+        }
+
+        result = inflate(stream, (gzip->span != 0 ? Z_BLOCK : Z_NO_FLUSH));
+        if (result == Z_STREAM_END) {
+            /* member trailer is not consumed by raw deflate */
+            position = (size_t)(stream->next_in - gzip->data) + (gzip->raw != 0 ? 8 : 0);
+            if (position + 1 < gzip->size && gzip->data[position] == 0x1f && gzip->data[position + 1] == 0x8b) {
+                if (inflateReset2(stream, 15 + 16) != Z_OK) {
+                    errno = EBADMSG;
+                    return -1;
+                }
+
+                stream->next_in  = (Bytef*)(gzip->data + position);
+                stream->avail_in = 0;
+                gzip->raw        = 0;
+            } else
+                gzip->end = 1;
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            errno = (result == Z_MEM_ERROR ? ENOMEM : EBADMSG);
+            return -1;
+        }
+
+        /* end of deflate block which is not last */
+        offset = gzip->offset + (size - stream->avail_out);
+        if (
+            gzip->span != 0 &&
+            (stream->data_type & 128) != 0 && (stream->data_type & 64) == 0 &&
+            (gzip->count == 0 || offset - gzip->points[gzip->count - 1].offset >= gzip->span) &&
+            tg_gzip_mark(gzip, offset) == TG_ERROR
+        )
+            return -1;
+    }
+
+    gzip->offset += size - stream->avail_out;
+
+    return (ssize_t)(size - stream->avail_out);
+}
+
+/**
+ * Search first timestamp of gzip file from start
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if file has no timestamps
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_gzip_first(tg_context* ctx, time_t* timestamp)
+{
+    int       result;
+    int       error;
+    tg_gzip   gzip;
+    tg_reader reader;
+
+    if (tg_gzip_open(&gzip, ctx->data, ctx->size, NULL) == TG_ERROR)
+        return TG_ERROR;
+
+    reader.read   = tg_gzip_read;
+    reader.source = &gzip;
+
+    result = tg_reader_first(ctx, &reader, 0, timestamp);
+
+    error = errno;
+    tg_gzip_close(&gzip);
+    errno = error;
+
+    return result;
+}
+
+/**
+ * Search last timestamp of gzip file from checkpoint to end of file
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if there are no timestamps after checkpoint
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_gzip_last(tg_context* ctx, const tg_gzip_point* point, time_t* timestamp)
+{
+    int       result;
+    int       error;
+    tg_gzip   gzip;
+    tg_reader reader;
+
+    if (tg_gzip_open(&gzip, ctx->data, ctx->size, point) == TG_ERROR)
+        return TG_ERROR;
+
+    reader.read   = tg_gzip_read;
+    reader.source = &gzip;
+
+    /* checkpoint may be inside string */
+    result = tg_reader_last(ctx, &reader, (point->coffset != 0), timestamp);
+
+    error = errno;
+    tg_gzip_close(&gzip);
+    errno = error;
+
+    return result;
+}
+
+/**
+ * Build checkpoint index of mapped gzip file to <filename>.tgidx
+ * Index holds inflate state (zran) at deflate block boundaries every TG_GZIP_SPAN
+ * uncompressed bytes with first timestamp after every checkpoint, so only one span
+ * has to be decompressed to search. File is decompressed once and only one string
+ * per checkpoint is parsed
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_gzip_index(tg_context* ctx, const struct stat* file_stat)
+{
+    int            result;
+    int            part;
+    int            continued;
+    size_t         length;
+    size_t         pending;
+    uint64_t       base;
+    uint64_t       start;
+    time_t         timestamp;
+    tg_stamp       stamp;
+    tg_gzip        gzip;
+    tg_reader      reader;
+    tg_gzip_header header;
+    char*          filename;
+    char*          data   = NULL;
+    size_t         size   = 0;
+    size_t         lbound = 0;
+    size_t         ubound = 0;
+
+    filename = NULL;
+
+    if (tg_gzip_open(&gzip, ctx->data, ctx->size, NULL) == TG_ERROR)
+        return TG_ERROR;
+
+    gzip.span = TG_GZIP_SPAN;
+
+    if (tg_gzip_mark(&gzip, 0) == TG_ERROR)
+        goto ERROR;
+
+    reader.read   = tg_gzip_read;
+    reader.source = &gzip;
+
+    base    = 0;
+    pending = 0;
+    part    = 0;
+    while (1) {
+        result = tg_read_stream_string(&reader, ctx->chunk, ctx->max_line, &data, &size, lbound, &ubound, &length);
+        if (result == TG_ERROR)
+            goto ERROR;
+        else if (result == TG_NOT_FOUND)
+            break;
+
+        /* parts of long string after first are not parsed */
+        continued = part;
+        part      = tg_string_continued(data, lbound, length);
+
+        /* first string with timestamp starting after checkpoints */
+        start = base + lbound;
+        if (continued == 0 && pending < gzip.count && gzip.points[pending].offset <= start) {
+            result = tg_get_timestamp(data + lbound, length, &ctx->parser, &stamp);
+            if (result == TG_ERROR)
+                goto ERROR;
+            else if (result == TG_FOUND && tg_stamp_time(&ctx->parser, &stamp, &timestamp) == TG_FOUND)
+                while (pending < gzip.count && gzip.points[pending].offset <= start)
+                    gzip.points[pending++].timestamp = (int64_t)timestamp;
+        }
+
+        lbound += length + 1;
+        if (ubound - lbound < lbound) {
+            memmove(data, data + lbound, ubound - lbound);
+
+            base  += lbound;
+            ubound = ubound - lbound;
+            lbound = 0;
+        }
+    }
+
+    memset(&header, 0, sizeof(header));
+    tg_index_header_init(ctx, file_stat, &header.index);
+    memcpy(header.index.magic, TG_GZIP_MAGIC, sizeof(header.index.magic));
+    header.index.step  = TG_GZIP_SPAN;
+    header.index.count = gzip.count;
+
+    /* last timestamp is in last span unless it has no timestamps at all */
+    result = tg_gzip_last(ctx, gzip.points + gzip.count - 1, &timestamp);
+    if (result == TG_ERROR)
+        goto ERROR;
+
+    header.last = (result == TG_FOUND ? (int64_t)timestamp : INT64_MAX);
+
+    filename = tg_filename(ctx->filename, TG_INDEX_SUFFIX);
+    if (filename == NULL)
+        goto ERROR;
+
+    if (tg_replace_file(filename, &header, sizeof(header), gzip.points, gzip.count * sizeof(tg_gzip_point)) == TG_ERROR)
+        goto ERROR;
+
+    result = TG_FOUND;
+
+    goto SUCCESS;
+
+ERROR:
+
+    result = TG_ERROR;
+
+SUCCESS:
+
+    length = (size_t)errno;
+
+    free(data);
+    free(filename);
+    tg_gzip_close(&gzip);
+
+    errno = (int)length;
+
+    return result;
+}
+
+/**
+ * Search checkpoint to decompress rotation set gzip file from (see tg_files_search)
+ * With checkpoint index first and last timestamps and checkpoint are taken from
+ * index, without index only first timestamp is read and file is decompressed from start
+ * Return TG_FOUND if file has strings after start (output may be empty)
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_gzip_search(tg_context* ctx, tg_file* file, const struct stat* file_stat)
+{
+    int                  result;
+    int                  last;
+    size_t               lower;
+    size_t               upper;
+    size_t               middle;
+    size_t               count;
+    tg_gzip_header       header;
+    const tg_gzip_point* points;
+
+    tg_index_map(ctx, file_stat, TG_GZIP_MAGIC, sizeof(tg_gzip_header), sizeof(tg_gzip_point));
+
+    last        = 0;
+    file->point = 0;
+
+    if (ctx->index_data != MAP_FAILED) {
+        memcpy(&header, ctx->index_data, sizeof(header));
+
+        count  = (size_t)header.index.count;
+        points = (const tg_gzip_point*)(const void*)(ctx->index_data + sizeof(header));
+
+        result = TG_NOT_FOUND;
+        if (count != 0 && points[0].timestamp != INT64_MAX) {
+            result      = TG_FOUND;
+            file->first = (time_t)points[0].timestamp;
+            file->last  = (time_t)header.last;
+            last        = (header.last != INT64_MAX);
+
+            /* last checkpoint with timestamp less than start */
+            lower = 0;
+            upper = count;
+            while (lower < upper) {
+                middle = lower + (upper - lower) / 2;
+                if (points[middle].timestamp < (int64_t)ctx->start)
+                    lower = middle + 1;
+                else
+                    upper = middle;
+            }
+
+            file->point = (lower == 0 ? 0 : lower - 1);
+        }
+
+        tg_index_close(ctx);
+    } else
+        result = tg_gzip_first(ctx, &file->first);
+
+    if (result != TG_FOUND)
+        return result;
+    else if (last != 0 && file->last < ctx->start)
+        return TG_NOT_FOUND;
+
+    /* output is decompressed, range only marks it is not empty */
+    file->lbound = 0;
+    file->ubound = (file->first >= ctx->stop ? 0 : 1);
+    file->whole  = (file->first >= ctx->start && last != 0 && file->last < ctx->stop);
+
+    return TG_FOUND;
+}
+
+/**
+ * Check checkpoint of index file against mapped gzip file (index may be corrupted while
+ * its header matches), so it is safe to pass to tg_gzip_open
+ * Return TG_FOUND if checkpoint is valid
+ * Return TG_NOT_FOUND otherwise
+ */
+static int tg_gzip_point_check(const tg_gzip_point* point, size_t size)
+{
+    if (point->coffset >= size || point->bits > 7 || point->length > TG_GZIP_WINDOW)
+        return TG_NOT_FOUND;
+    else if (point->coffset == 0 && point->offset != 0)
+        return TG_NOT_FOUND;
+
+    return TG_FOUND;
+}
+
+/**
+ * Print strings of mapped rotation set gzip file decompressed from checkpoint found by tg_gzip_search
+ * Invalid checkpoint is ignored and file is decompressed from start
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_gzip_output(tg_context* ctx, const tg_file* file, const struct stat* file_stat)
+{
+    int                  result;
+    int                  error;
+    tg_gzip              gzip;
+    tg_reader            reader;
+    const tg_gzip_point* point;
+
+    /* index may be removed or replaced after search */
+    point = NULL;
+    if (file->point != 0) {
+        tg_index_map(ctx, file_stat, TG_GZIP_MAGIC, sizeof(tg_gzip_header), sizeof(tg_gzip_point));
+        if (ctx->index_data != MAP_FAILED && file->point < (ctx->index_size - sizeof(tg_gzip_header)) / sizeof(tg_gzip_point))
+            point = (const tg_gzip_point*)(const void*)(ctx->index_data + sizeof(tg_gzip_header)) + file->point;
+
+        if (point != NULL && tg_gzip_point_check(point, ctx->size) != TG_FOUND)
+            point = NULL;
+    }
+
+    result = tg_gzip_open(&gzip, ctx->data, ctx->size, point);
+    if (result != TG_ERROR) {
+        reader.read   = tg_gzip_read;
+        reader.source = &gzip;
+
+        result = tg_stream_filter(ctx, &reader, (point != NULL), file->whole);
+
+        error = errno;
+        tg_gzip_close(&gzip);
+        errno = error;
+    }
+
+    tg_index_close(ctx);
+
+    return result;
+}
+
+#endif
+
+#ifdef TG_WITH_ZSTD
+
+/**
+ * zstd reader of mapped file for tg_reader
+ */
+typedef struct {
+    ZSTD_DCtx*    context;    /* decompression context                    */
+    ZSTD_inBuffer input;      /* compressed data from frame to file end   */
+    size_t        pending;    /* last ZSTD_decompressStream hint          */
+} tg_zstd;
+
+/**
+ * Read little endian 32 bit value
+ */
+static uint32_t tg_zstd_le32(const char* data)
+{
+    const unsigned char* byte = (const unsigned char*)data;
+
+    return (uint32_t)byte[0] | ((uint32_t)byte[1] << 8) | ((uint32_t)byte[2] << 16) | ((uint32_t)byte[3] << 24);
+}
+
+/**
+ * Start decompression of mapped file from frame at offset
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_zstd_open(tg_zstd* zstd, const char* data, size_t size, size_t offset)
+{
+    memset(zstd, 0, sizeof(*zstd));
+
+    zstd->context = ZSTD_createDCtx();
+    if (zstd->context == NULL) {
+        errno = ENOMEM;
+        return TG_ERROR;
+    }
+
+    zstd->input.src  = data + offset;
+    zstd->input.size = size - offset;
+    zstd->input.pos  = 0;
+
+    return TG_FOUND;
+}
+
+/**
+ * Free decompression context
+ */
+static void tg_zstd_close(tg_zstd* zstd)
+{
+    ZSTD_freeDCtx(zstd->context);
+    zstd->context = NULL;
+}
+
+/**
+ * Read function of zstd reader for tg_reader
+ * Frames are read as single stream, skippable frames (seek table) are skipped
+ */
+static ssize_t tg_zstd_read(void* source, char* buffer, size_t size)
+{
+    tg_zstd*       zstd = source;
+    ZSTD_outBuffer output;
+
+    output.dst  = buffer;
+    output.size = size;
+    output.pos  = 0;
+
+    /* data may be buffered in context after input end */
+    while (output.pos == 0 && (zstd->input.pos < zstd->input.size || zstd->pending != 0)) {
+        zstd->pending = ZSTD_decompressStream(zstd->context, &output, &zstd->input);
+        if (ZSTD_isError(zstd->pending) || (output.pos == 0 && zstd->input.pos == zstd->input.size && zstd->pending != 0)) {
+            errno = EBADMSG;
+            return -1;
+        }
+    }
+
+    return (ssize_t)output.pos;
+}
+
+/**
+ * Frame offsets of mapped zstd file from seek table (seekable format) or by frame
+ * headers scan (frames are not decompressed) if there is no seek table
+ * Return TG_FOUND on success, frames must be freed
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_zstd_frames(const tg_context* ctx, size_t** frames, size_t* count)
+{
+    size_t   i;
+    size_t   entry;
+    size_t   table;
+    size_t   offset;
+    size_t   length;
+    size_t*  offsets;
+    uint32_t number;
+
+    *frames = NULL;
+    *count  = 0;
+
+    /* seek table is skippable frame at end of file */
+    table = 0;
+    if (ctx->size >= 17 && tg_zstd_le32(ctx->data + ctx->size - 4) == TG_ZSTD_SEEKABLE_MAGIC) {
+        number = tg_zstd_le32(ctx->data + ctx->size - 9);
+        entry  = ((unsigned char)ctx->data[ctx->size - 5] & 0x80 ? 12 : 8);
+
+        if (number < (ctx->size - 17) / entry) {
+            table = ctx->size - 17 - number * entry;
+            if (
+                tg_zstd_le32(ctx->data + table) != TG_ZSTD_SEEK_TABLE_MAGIC ||
+                tg_zstd_le32(ctx->data + table + 4) != number * entry + 9
+            )
+                table = 0;
+        }
+    }
+
+    if (table != 0) {
+        *frames = malloc((number + 1) * sizeof(size_t));
+        if (*frames == NULL)
+            return TG_ERROR;
+
+        offset = 0;
+        for (i = 0; i < number && offset < table; i++) {
+            (*frames)[i] = offset;
+            offset += tg_zstd_le32(ctx->data + table + 8 + i * entry);
+        }
+
+        if (i == number && offset == table) {
+            *count = number;
+            return TG_FOUND;
+        }
+
+        /* broken seek table */
+        free(*frames);
+        *frames = NULL;
+    }
+
+    offset = 0;
+    length = 0;
+    while (offset < ctx->size) {
+        /* broken or truncated frame is left to decompression to report error */
+        entry = ZSTD_findFrameCompressedSize(ctx->data + offset, ctx->size - offset);
+        if (ZSTD_isError(entry) || entry == 0)
+            entry = ctx->size - offset;
+
+        /* skippable frames have no data */
+        if (ctx->size - offset < 4 || (tg_zstd_le32(ctx->data + offset) & 0xFFFFFFF0) != TG_ZSTD_SKIPPABLE_MAGIC) {
+            if (*count == length) {
+                length = (length == 0 ? 1024 : length * 2);
+
+                offsets = realloc(*frames, length * sizeof(size_t));
+                if (offsets == NULL) {
+                    free(*frames);
+                    *frames = NULL;
+                    *count  = 0;
+                    return TG_ERROR;
+                }
+
+                *frames = offsets;
+            }
+
+            (*frames)[(*count)++] = offset;
+        }
+
+        offset += entry;
+    }
+
+    return TG_FOUND;
+}
+
+/**
+ * Search first timestamp of zstd file decompressed from frame at offset
+ * Frame may start inside string, so first string is skipped if skip is set
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if there are no timestamps after offset
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_zstd_first(tg_context* ctx, size_t offset, int skip, time_t* timestamp)
+{
+    int       result;
+    int       error;
+    tg_zstd   zstd;
+    tg_reader reader;
+
+    if (tg_zstd_open(&zstd, ctx->data, ctx->size, offset) == TG_ERROR)
+        return TG_ERROR;
+
+    reader.read   = tg_zstd_read;
+    reader.source = &zstd;
+
+    result = tg_reader_first(ctx, &reader, skip, timestamp);
+
+    error = errno;
+    tg_zstd_close(&zstd);
+    errno = error;
+
+    return result;
+}
+
+/**
+ * Search last timestamp of zstd file in last frame (decompressed to memory)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if there are no timestamps in frame or frame is too large
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_zstd_last(tg_context* ctx, size_t offset, time_t* timestamp)
+{
+    int       result;
+    int       error;
+    uint64_t  content;
+    tg_zstd   zstd;
+    tg_reader reader;
+
+    /* unknown content size is (0ULL - 1) and error is (0ULL - 2) */
+    content = (uint64_t)ZSTD_getFrameContentSize(ctx->data + offset, ctx->size - offset);
+    if (content >= (uint64_t)0 - 2 || content > TG_LAST_BLOCK_SIZE)
+        return TG_NOT_FOUND;
+
+    if (tg_zstd_open(&zstd, ctx->data, ctx->size, offset) == TG_ERROR)
+        return TG_ERROR;
+
+    reader.read   = tg_zstd_read;
+    reader.source = &zstd;
+
+    /* frame may start inside string */
+    result = tg_reader_last(ctx, &reader, 1, timestamp);
+
+    error = errno;
+    tg_zstd_close(&zstd);
+    errno = error;
+
+    return result;
+}
+
+/**
+ * Search frame to decompress rotation set zstd file from (see tg_files_search)
+ * Frames are bisected by first timestamp after frame start, so only beginning of
+ * O(log frames) frames is decompressed. Checkpoint is compressed offset of frame
+ * Return TG_FOUND if file has strings after start (output may be empty)
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_zstd_search(tg_context* ctx, tg_file* file)
+{
+    int     result;
+    int     last;
+    size_t  lower;
+    size_t  upper;
+    size_t  middle;
+    size_t  count;
+    size_t* frames;
+    time_t  timestamp;
+
+    if (tg_zstd_frames(ctx, &frames, &count) == TG_ERROR)
+        return TG_ERROR;
+
+    file->point = 0;
+
+    result = TG_NOT_FOUND;
+    if (count != 0)
+        result = tg_zstd_first(ctx, frames[0], 0, &file->first);
+
+    if (result != TG_FOUND)
+        goto SUCCESS;
+
+    last = 0;
+    if (count > 1) {
+        result = tg_zstd_last(ctx, frames[count - 1], &file->last);
+        if (result == TG_ERROR)
+            goto SUCCESS;
+
+        last = (result == TG_FOUND);
+    }
+
+    result = TG_NOT_FOUND;
+    if (last != 0 && file->last < ctx->start)
+        goto SUCCESS;
+
+    /* first frame with strings not less than start after its start */
+    lower = 1;
+    upper = count;
+    while (file->first < ctx->start && lower < upper) {
+        middle = lower + (upper - lower) / 2;
+
+        result = tg_zstd_first(ctx, frames[middle], 1, &timestamp);
+        if (result == TG_ERROR)
+            goto SUCCESS;
+        else if (result == TG_FOUND && timestamp < ctx->start)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+
+    if (file->first < ctx->start && lower > 1)
+        file->point = frames[lower - 1];
+
+    /* output is decompressed, range only marks it is not empty */
+    file->lbound = 0;
+    file->ubound = (file->first >= ctx->stop ? 0 : 1);
+    file->whole  = (file->first >= ctx->start && last != 0 && file->last < ctx->stop);
+
+    result = TG_FOUND;
+
+SUCCESS:
+
+    count = (size_t)errno;
+    free(frames);
+    errno = (int)count;
+
+    return result;
+}
+
+/**
+ * Print strings of mapped rotation set zstd file decompressed from frame found by tg_zstd_search
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_zstd_output(tg_context* ctx, const tg_file* file)
+{
+    int       result;
+    int       error;
+    tg_zstd   zstd;
+    tg_reader reader;
+
+    /* file may be replaced after search */
+    if (file->point >= ctx->size)
+        return TG_NOT_FOUND;
+
+    if (tg_zstd_open(&zstd, ctx->data, ctx->size, file->point) == TG_ERROR)
+        return TG_ERROR;
+
+    reader.read   = tg_zstd_read;
+    reader.source = &zstd;
+
+    result = tg_stream_filter(ctx, &reader, (file->point != 0), file->whole);
+
+    error = errno;
+    tg_zstd_close(&zstd);
+    errno = error;
+
+    return result;
+}
+
+#endif
+
+#ifdef TG_WITH_LZMA
+
+/**
+ * xz reader of mapped file for tg_reader
+ * Blocks are decoded one by one by index, so reading may start from any block
+ */
+typedef struct {
+    const uint8_t*  data;                            /* mapped file                */
+    lzma_stream     stream;                          /* block decoder              */
+    lzma_block      block;                           /* current block header       */
+    lzma_filter     filters[LZMA_FILTERS_MAX + 1];   /* current block filters      */
+    lzma_index_iter iter;                            /* current block in index     */
+    int             end;                             /* last block is decoded      */
+} tg_xz;
+
+/**
+ * Set errno by lzma error
+ */
+static void tg_xz_errno(lzma_ret ret)
+{
+    if (ret == LZMA_MEM_ERROR || ret == LZMA_MEMLIMIT_ERROR)
+        errno = ENOMEM;
+    else
+        errno = EBADMSG;
+}
+
+/**
+ * Decode index of all streams of mapped xz file (only stream headers, footers
+ * and indexes are read)
+ * Return TG_FOUND on success, index must be freed with lzma_index_end
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_xz_index(const tg_context* ctx, lzma_index** index)
+{
+    lzma_ret    ret;
+    lzma_stream stream = LZMA_STREAM_INIT;
+
+    *index = NULL;
+
+    ret = lzma_file_info_decoder(&stream, index, UINT64_MAX, ctx->size);
+    if (ret != LZMA_OK) {
+        tg_xz_errno(ret);
+        return TG_ERROR;
+    }
+
+    stream.next_in  = (const uint8_t*)ctx->data;
+    stream.avail_in = ctx->size;
+
+    /* input is mapped, so seek is just pointer move */
+    while ((ret = lzma_code(&stream, LZMA_RUN)) == LZMA_SEEK_NEEDED) {
+        stream.next_in  = (const uint8_t*)ctx->data + stream.seek_pos;
+        stream.avail_in = ctx->size - (size_t)stream.seek_pos;
+    }
+
+    lzma_end(&stream);
+
+    if (ret != LZMA_STREAM_END) {
+        lzma_index_end(*index, NULL);
+        *index = NULL;
+
+        tg_xz_errno(ret);
+        return TG_ERROR;
+    }
+
+    return TG_FOUND;
+}
+
+/**
+ * Free filter options of current block
+ */
+static void tg_xz_filters_free(tg_xz* xz)
+{
+    size_t i;
+
+    for (i = 0; xz->filters[i].id != LZMA_VLI_UNKNOWN; i++) {
+        free(xz->filters[i].options);
+        xz->filters[i].options = NULL;
+    }
+
+    xz->filters[0].id = LZMA_VLI_UNKNOWN;
+}
+
+/**
+ * Start decoding of current block of index iterator
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_xz_block(tg_xz* xz)
+{
+    lzma_ret       ret;
+    const uint8_t* header = xz->data + xz->iter.block.compressed_file_offset;
+
+    tg_xz_filters_free(xz);
+
+    memset(&xz->block, 0, sizeof(xz->block));
+
+    xz->block.version     = 1;
+    xz->block.check       = xz->iter.stream.flags->check;
+    xz->block.filters     = xz->filters;
+    xz->block.header_size = lzma_block_header_size_decode(*header);
+
+    ret = lzma_block_header_decode(&xz->block, NULL, header);
+    if (ret == LZMA_OK)
+        ret = lzma_block_compressed_size(&xz->block, xz->iter.block.unpadded_size);
+    if (ret == LZMA_OK)
+        ret = lzma_block_decoder(&xz->stream, &xz->block);
+
+    if (ret != LZMA_OK) {
+        tg_xz_errno(ret);
+        return TG_ERROR;
+    }
+
+    xz->stream.next_in  = header + xz->block.header_size;
+    xz->stream.avail_in = (size_t)(xz->iter.block.total_size - xz->block.header_size);
+
+    return TG_FOUND;
+}
+
+/**
+ * Start decoding of mapped xz file from block with uncompressed offset
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if there is no such block
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_xz_open(tg_xz* xz, const char* data, const lzma_index* index, uint64_t offset)
+{
+    lzma_stream stream = LZMA_STREAM_INIT;
+
+    memset(xz, 0, sizeof(*xz));
+
+    xz->data          = (const uint8_t*)data;
+    xz->stream        = stream;
+    xz->filters[0].id = LZMA_VLI_UNKNOWN;
+
+    lzma_index_iter_init(&xz->iter, index);
+    if (lzma_index_iter_locate(&xz->iter, offset) != 0)
+        return TG_NOT_FOUND;
+
+    if (tg_xz_block(xz) == TG_ERROR) {
+        lzma_end(&xz->stream);
+        return TG_ERROR;
+    }
+
+    return TG_FOUND;
+}
+
+/**
+ * Free decoder
+ */
+static void tg_xz_close(tg_xz* xz)
+{
+    lzma_end(&xz->stream);
+    tg_xz_filters_free(xz);
+}
+
+/**
+ * Read function of xz reader for tg_reader
+ */
+static ssize_t tg_xz_read(void* source, char* buffer, size_t size)
+{
+    lzma_ret ret;
+    tg_xz*   xz = source;
+
+    xz->stream.next_out  = (uint8_t*)buffer;
+    xz->stream.avail_out = size;
+
+    while (xz->end == 0 && xz->stream.avail_out == size) {
+        ret = lzma_code(&xz->stream, LZMA_RUN);
+        if (ret == LZMA_STREAM_END) {
+            if (lzma_index_iter_next(&xz->iter, LZMA_INDEX_ITER_NONEMPTY_BLOCK) != 0)
+                xz->end = 1;
+            else if (tg_xz_block(xz) == TG_ERROR)
+                return -1;
+        } else if (ret != LZMA_OK) {
+            tg_xz_errno(ret);
+            return -1;
+        }
+    }
+
+    return (ssize_t)(size - xz->stream.avail_out);
+}
+
+/**
+ * Search first timestamp of xz file decoded from block with uncompressed offset
+ * Block may start inside string, so first string is skipped if skip is set
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if there are no timestamps after offset
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_xz_first(tg_context* ctx, const lzma_index* index, uint64_t offset, int skip, time_t* timestamp)
+{
+    int       result;
+    int       error;
+    tg_xz     xz;
+    tg_reader reader;
+
+    result = tg_xz_open(&xz, ctx->data, index, offset);
+    if (result != TG_FOUND)
+        return result;
+
+    reader.read   = tg_xz_read;
+    reader.source = &xz;
+
+    result = tg_reader_first(ctx, &reader, skip, timestamp);
+
+    error = errno;
+    tg_xz_close(&xz);
+    errno = error;
+
+    return result;
+}
+
+/**
+ * Search last timestamp of xz file in block with uncompressed offset (decoded to memory)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if there are no timestamps in block
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_xz_last(tg_context* ctx, const lzma_index* index, uint64_t offset, time_t* timestamp)
+{
+    int       result;
+    int       error;
+    tg_xz     xz;
+    tg_reader reader;
+
+    result = tg_xz_open(&xz, ctx->data, index, offset);
+    if (result != TG_FOUND)
+        return result;
+
+    reader.read   = tg_xz_read;
+    reader.source = &xz;
+
+    /* block may start inside string */
+    result = tg_reader_last(ctx, &reader, (offset != 0), timestamp);
+
+    error = errno;
+    tg_xz_close(&xz);
+    errno = error;
+
+    return result;
+}
+
+/**
+ * Search block to decode rotation set xz file from (see tg_files_search)
+ * Blocks from xz index are bisected by first timestamp after block start, so only
+ * beginning of O(log blocks) blocks is decoded (files compressed by single thread
+ * have one block and are decoded from start). Checkpoint is uncompressed offset of block
+ * Return TG_FOUND if file has strings after start (output may be empty)
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_xz_search(tg_context* ctx, tg_file* file)
+{
+    int             result;
+    int             last;
+    size_t          lower;
+    size_t          upper;
+    size_t          middle;
+    size_t          count;
+    uint64_t*       blocks;
+    time_t          timestamp;
+    lzma_index*     index;
+    lzma_index_iter iter;
+
+    if (tg_xz_index(ctx, &index) == TG_ERROR)
+        return TG_ERROR;
+
+    result = TG_ERROR;
+
+    blocks = malloc(((size_t)lzma_index_block_count(index) + 1) * sizeof(uint64_t));
+    if (blocks == NULL)
+        goto SUCCESS;
+
+    count = 0;
+    lzma_index_iter_init(&iter, index);
+    while (lzma_index_iter_next(&iter, LZMA_INDEX_ITER_NONEMPTY_BLOCK) == 0)
+        blocks[count++] = iter.block.uncompressed_file_offset;
+
+    file->point = 0;
+
+    result = TG_NOT_FOUND;
+    if (count != 0)
+        result = tg_xz_first(ctx, index, blocks[0], 0, &file->first);
+
+    if (result != TG_FOUND)
+        goto SUCCESS;
+
+    last = 0;
+    if (count > 1 && lzma_index_uncompressed_size(index) - blocks[count - 1] <= TG_LAST_BLOCK_SIZE) {
+        result = tg_xz_last(ctx, index, blocks[count - 1], &file->last);
+        if (result == TG_ERROR)
+            goto SUCCESS;
+
+        last = (result == TG_FOUND);
+    }
+
+    result = TG_NOT_FOUND;
+    if (last != 0 && file->last < ctx->start)
+        goto SUCCESS;
+
+    /* first block with strings not less than start after its start */
+    lower = 1;
+    upper = count;
+    while (file->first < ctx->start && lower < upper) {
+        middle = lower + (upper - lower) / 2;
+
+        result = tg_xz_first(ctx, index, blocks[middle], 1, &timestamp);
+        if (result == TG_ERROR)
+            goto SUCCESS;
+        else if (result == TG_FOUND && timestamp < ctx->start)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+
+    if (file->first < ctx->start && lower > 1)
+        file->point = (size_t)blocks[lower - 1];
+
+    /* output is decoded, range only marks it is not empty */
+    file->lbound = 0;
+    file->ubound = (file->first >= ctx->stop ? 0 : 1);
+    file->whole  = (file->first >= ctx->start && last != 0 && file->last < ctx->stop);
+
+    result = TG_FOUND;
+
+SUCCESS:
+
+    middle = (size_t)errno;
+
+    free(blocks);
+    lzma_index_end(index, NULL);
+
+    errno = (int)middle;
+
+    return result;
+}
+
+/**
+ * Print strings of mapped rotation set xz file decoded from block found by tg_xz_search
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_xz_output(tg_context* ctx, const tg_file* file)
+{
+    int         result;
+    int         error;
+    tg_xz       xz;
+    tg_reader   reader;
+    lzma_index* index;
+
+    if (tg_xz_index(ctx, &index) == TG_ERROR)
+        return TG_ERROR;
+
+    /* file may be replaced after search */
+    result = tg_xz_open(&xz, ctx->data, index, file->point);
+    if (result == TG_FOUND) {
+        reader.read   = tg_xz_read;
+        reader.source = &xz;
+
+        result = tg_stream_filter(ctx, &reader, (file->point != 0), file->whole);
+
+        error = errno;
+        tg_xz_close(&xz);
+        errno = error;
+    }
+
+    error = errno;
+    lzma_index_end(index, NULL);
+    errno = error;
+
+    return result;
+}
+
+#endif
+
+/**
+ * Search output range of compressed rotation set file (see tg_files_search)
+ * Return TG_FOUND if file has strings after start (output may be empty)
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_compressed_search(tg_context* ctx, tg_file* file, const struct stat* file_stat)
+{
+#ifdef TG_WITH_ZLIB
+    if (file->compressed == TG_COMPRESSED_GZIP)
+        return tg_gzip_search(ctx, file, file_stat);
+#endif
+#ifdef TG_WITH_ZSTD
+    if (file->compressed == TG_COMPRESSED_ZSTD)
+        return tg_zstd_search(ctx, file);
+#endif
+#ifdef TG_WITH_LZMA
+    if (file->compressed == TG_COMPRESSED_XZ)
+        return tg_xz_search(ctx, file);
+#endif
+
+    (void)ctx;
+    (void)file;
+    (void)file_stat;
+
+    errno = EINVAL;
+
+    return TG_ERROR;
+}
+
+/**
+ * Print strings of mapped compressed rotation set file (see tg_files_timegrep)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_compressed_output(tg_context* ctx, const tg_file* file, const struct stat* file_stat)
+{
+#ifdef TG_WITH_ZLIB
+    if (file->compressed == TG_COMPRESSED_GZIP)
+        return tg_gzip_output(ctx, file, file_stat);
+#endif
+#ifdef TG_WITH_ZSTD
+    if (file->compressed == TG_COMPRESSED_ZSTD)
+        return tg_zstd_output(ctx, file);
+#endif
+#ifdef TG_WITH_LZMA
+    if (file->compressed == TG_COMPRESSED_XZ)
+        return tg_xz_output(ctx, file);
+#endif
+
+    (void)ctx;
+    (void)file;
+    (void)file_stat;
+
+    errno = EINVAL;
+
+    return TG_ERROR;
+}
+
+/**
+ * Build index of compressed mapped file (see tg_file_index)
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_compressed_index(tg_context* ctx, const struct stat* file_stat)
+{
+#ifdef TG_WITH_ZLIB
+    if (tg_file_compressed(ctx) == TG_COMPRESSED_GZIP)
+        return tg_gzip_index(ctx, file_stat);
+#endif
+#ifdef TG_WITH_ZSTD
+    /* seek table or frames are index */
+    if (tg_file_compressed(ctx) == TG_COMPRESSED_ZSTD)
+        return TG_FOUND;
+#endif
+#ifdef TG_WITH_LZMA
+    /* block index is index */
+    if (tg_file_compressed(ctx) == TG_COMPRESSED_XZ)
+        return TG_FOUND;
+#endif
+
+    (void)ctx;
+    (void)file_stat;
+
+    errno = EINVAL;
+
+    return TG_ERROR;
+}
+
+/**
+ * Search output range [lbound, ubound) of mapped file
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_file_search(tg_context* ctx, size_t* lbound, size_t* ubound)
+{
+    int     result;
+    size_t  lower;
+    size_t  upper;
+
+    int (*search)(const char*, size_t, tg_parser*, time_t, const char*, size_t, size_t*, tg_probes*);
+
+    if (ctx->search == TG_SEARCH_BINARY)
+        search = tg_binary_search;
+    else if (ctx->search == TG_SEARCH_TAIL)
+        search = tg_tail_search;
+    else
+        search = tg_interpolation_search;
+
+    ctx->probes.count = 0;
+
+    lower = ctx->hole;
+    upper = ctx->size;
+    tg_index_bracket(ctx, ctx->start, &lower, &upper);
+
+    result = TG_NOT_FOUND;
+    if (lower < upper)
+        result = search(
+            ctx->data,
+            upper,
+            &ctx->parser,
+            ctx->start,
+            ctx->start_key,
+            lower,
+            lbound,
+            &ctx->probes
+        );
+
+    if (result == TG_ERROR)
+        return result;
+    else if (result == TG_NOT_FOUND) {
+        if (upper == ctx->size)
+            return result;
+
+        *lbound = upper;
+    }
+
+    /* lines seen by start search bracket stop search */
+    lower = *lbound;
+    upper = ctx->size;
+    tg_index_bracket(ctx, ctx->stop, &lower, &upper);
+    tg_probes_bracket(&ctx->probes, ctx->data, ctx->size, &ctx->parser, ctx->stop, ctx->stop_key, &lower, &upper);
+
+    result = TG_NOT_FOUND;
+    if (lower < upper)
+        result = search(
+            ctx->data,
+            upper,
+            &ctx->parser,
+            ctx->stop,
+            ctx->stop_key,
+            lower,
+            ubound,
+            NULL
+        );
+
+    if (result == TG_ERROR)
+        return result;
+    else if (result == TG_NOT_FOUND)
+        *ubound = upper;
+
+    return TG_FOUND;
+}
+
+#ifdef __linux__
+/**
+ * Copy range [*lbound, ubound) of ctx->fd to stdout inside kernel without
+ * touching mapped memory: splice if stdout is pipe, copy_file_range if stdout
+ * is regular file and sendfile otherwise (socket, regular file of other fs)
+ * *lbound is advanced by copied bytes
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if stdout does not support kernel copy, rest must be written
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_file_copy(const tg_context* ctx, size_t* lbound, size_t ubound)
+{
+    ssize_t     actual;
+    size_t      length;
+    loff_t      offset;
+    off_t       position;
+    struct stat out_stat;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+    int         range;
+#endif
+
+    if (ctx->fd == -1 || fstat(STDOUT_FILENO, &out_stat) == -1)
+        return TG_NOT_FOUND;
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+    range = S_ISREG(out_stat.st_mode);
+#endif
+
+    while (*lbound < ubound) {
+        length = ubound - *lbound;
+        if (length > (size_t)INT_MAX)
+            length = (size_t)INT_MAX;
+
+        if (S_ISFIFO(out_stat.st_mode)) {
+            offset = (loff_t)*lbound;
+            actual = splice(ctx->fd, &offset, STDOUT_FILENO, NULL, length, SPLICE_F_MORE);
+        }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+        else if (range != 0) {
+            offset = (loff_t)*lbound;
+            actual = copy_file_range(ctx->fd, &offset, STDOUT_FILENO, NULL, length, 0);
+            if (actual == -1 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP)) {
+                /* different / unsupported fs, retry with sendfile */
+                range = 0;
+                continue;
+            }
+        }
+#endif
+        else {
+            position = (off_t)*lbound;
+            actual   = sendfile(STDOUT_FILENO, ctx->fd, &position, length);
+        }
+
+        if (actual == -1) {
+            if (errno == EINTR)
+                continue;
+            else if (errno == EINVAL || errno == ENOSYS || errno == EXDEV || errno == EBADF || errno == EOPNOTSUPP)
+                return TG_NOT_FOUND;    /* tty, O_APPEND, ... */
+
+            return TG_ERROR;
+        } else if (actual == 0)
+            return TG_NOT_FOUND;        /* file is truncated, let write report */
+
+        *lbound += (size_t)actual;
+    }
+
+    return TG_FOUND;
+}
+#endif
+
+/**
+ * Write range [lbound, ubound) of mapped file to stdout
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_file_output(const tg_context* ctx, size_t lbound, size_t ubound)
+{
+#ifdef __linux__
+    int     result;
+#endif
+    ssize_t actual;
+    size_t  length;
+    size_t  lbound_aligned;
+    size_t  ubound_aligned;
+    size_t  page_size = (size_t)getpagesize();
+    size_t  page_mask = ~(page_size - 1);
+
+#ifdef __linux__
+    result = tg_file_copy(ctx, &lbound, ubound);
+    if (result != TG_NOT_FOUND)
+        return result;
+#endif
+
+    lbound_aligned = lbound & page_mask;
+    while (lbound < ubound) {
+        length = ctx->chunk;
+        if (lbound + length >= ubound)
+            length = ubound - lbound;
+
+        actual = write(STDOUT_FILENO, ctx->data + lbound, length);
+        if (actual == -1)
+            return TG_ERROR;
+
+        lbound += (size_t)actual;
+
+        if (lbound_aligned + ctx->chunk < lbound) {
+            ubound_aligned = lbound & page_mask;
+            if (lbound_aligned < ubound_aligned)
+                madvise((void*)(ctx->data + lbound_aligned), ubound_aligned - lbound_aligned, MADV_DONTNEED);
+
+            lbound_aligned = ubound_aligned;
+        }
+    }
+
+    return TG_FOUND;
+}
+
+/**
+ * Open and map ctx->filename
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if file is empty (nothing mapped)
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_file_map(tg_context* ctx, struct stat* file_stat)
+{
+    ctx->size = 0;
+    ctx->hole = 0;
+
+    ctx->fd = open(ctx->filename, O_RDONLY);
+    if (ctx->fd == -1)
+        return TG_ERROR;
+
+    if (fstat(ctx->fd, file_stat) == -1)
+        return TG_ERROR;
+    else if (file_stat->st_size == 0)
+        return TG_NOT_FOUND;
+
+    /* preferred to compile with -D_FILE_OFFSET_BITS=64 */
+    ctx->size = (size_t)file_stat->st_size;
+
+    ctx->data = mmap(NULL, ctx->size, PROT_READ, MAP_PRIVATE, ctx->fd, 0);
+    if (ctx->data == MAP_FAILED)
+        return TG_ERROR;
+
+    ctx->hole = tg_file_hole(ctx->fd, ctx->size);
+
+    /* descriptor is kept open for kernel copy in tg_file_output */
+    return TG_FOUND;
+}
+
+/**
+ * Unmap file mapped with tg_file_map
+ */
+static void tg_file_unmap(tg_context* ctx)
+{
+    if (ctx->data != MAP_FAILED) {
+        munmap(ctx->data, ctx->size);
+        ctx->data = MAP_FAILED;
+    }
+
+    if (ctx->fd != -1) {
+        close(ctx->fd);
+        ctx->fd = -1;
+    }
+
+    ctx->size = 0;
+    ctx->hole = 0;
+}
+
+/**
+ * Read state file of previous run
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if there is no valid state file (first run)
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_state_read(const char* filename, tg_state* state)
+{
+    int     fd;
+    ssize_t actual;
+
+    fd = open(filename, O_RDONLY);
+    if (fd == -1)
+        return (errno == ENOENT ? TG_NOT_FOUND : TG_ERROR);
+
+    actual = read(fd, state, sizeof(*state));
+    close(fd);
+
+    if (actual == -1)
+        return TG_ERROR;
+    else if ((size_t)actual != sizeof(*state) || memcmp(state->magic, TG_STATE_MAGIC, sizeof(state->magic)) != 0)
+        return TG_NOT_FOUND;
+
+    return TG_FOUND;
+}
+
+/**
+ * Search file with inode of previous run in directory of filename (rotated file)
+ * Return allocated filename or NULL if not found
+ */
+static char* tg_state_rotated(const char* filename, const tg_state* state)
+{
+    DIR*           dir;
+    struct dirent* entry;
+    struct stat    entry_stat;
+    char*          dirname;
+    char*          result;
+    const char*    slash;
+    size_t         length;
+
+    slash = strrchr(filename, '/');
+    if (slash == NULL)
+        dirname = tg_filename(".", "");
+    else {
+        length  = (slash == filename ? 1 : (size_t)(slash - filename));
+        dirname = malloc(length + 1);
+        if (dirname != NULL) {
+            memcpy(dirname, filename, length);
+            dirname[length] = 0;
+        }
+    }
+
+    if (dirname == NULL)
+        return NULL;
+
+    result = NULL;
+
+    dir = opendir(dirname);
+    while (dir != NULL && result == NULL && (entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        length = strlen(dirname);
+        result = malloc(length + strlen(entry->d_name) + 2);
+        if (result == NULL)
+            break;
+
+        memcpy(result, dirname, length);
+        result[length] = '/';
+        strcpy(result + length + 1, entry->d_name);
+
+        if (stat(result, &entry_stat) == -1 || (uint64_t)entry_stat.st_dev != state->dev || (uint64_t)entry_stat.st_ino != state->ino) {
+            free(result);
+            result = NULL;
+        }
+    }
+
+    if (dir != NULL)
+        closedir(dir);
+
+    free(dirname);
+
+    return result;
+}
+
+/**
+ * End of last complete string in [lbound, ubound) or lbound
+ */
+static size_t tg_complete_end(const char* data, size_t lbound, size_t ubound)
+{
+    const char* nl;
+
+    if (lbound >= ubound)
+        return lbound;
+
+    nl = memrchr(data + lbound, '\n', ubound - lbound);
+    if (nl == NULL)
+        return lbound;
+
+    return (size_t)(nl - data) + 1;
+}
+
+/**
+ * File timegrep since previous run (--state)
+ * First run searches range with tg_file_search, next runs output complete strings from
+ * offset where previous run stopped. If file was rotated, rest of previous file
+ * is found by inode in the same directory and printed first
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_state_timegrep(tg_context* ctx)
+{
+    int         result;
+    int         retval;
+    tg_state    state;
+    struct stat file_stat;
+    const char* filename;
+    char*       rotated;
+    size_t      lbound;
+    size_t      ubound;
+
+    retval = TG_NOT_FOUND;
+
+    result = tg_state_read(ctx->state, &state);
+    if (result == TG_ERROR)
+        return TG_ERROR;
+
+    if (result == TG_FOUND) {
+        if (stat(ctx->filename, &file_stat) == -1)
+            return TG_ERROR;
+
+        if ((uint64_t)file_stat.st_dev != state.dev || (uint64_t)file_stat.st_ino != state.ino) {
+            /* rest of rotated file */
+            rotated = tg_state_rotated(ctx->filename, &state);
+            if (rotated != NULL) {
+                filename      = ctx->filename;
+                ctx->filename = rotated;
+
+                result = tg_file_map(ctx, &file_stat);
+                if (result == TG_FOUND && state.offset < ctx->size) {
+                    result = tg_file_output(ctx, (size_t)state.offset, ctx->size);
+                    retval = TG_FOUND;
+                }
+
+                tg_file_unmap(ctx);
+
+                ctx->filename = filename;
+                free(rotated);
+
+                if (result == TG_ERROR)
+                    return TG_ERROR;
+            }
+
+            state.offset = 0;
+        }
+
+        result = tg_file_map(ctx, &file_stat);
+        if (result == TG_ERROR)
+            return TG_ERROR;
+
+        lbound = (size_t)state.offset;
+        if (lbound > ctx->size)
+            lbound = 0;     /* truncated (copytruncate rotation) */
+
+        if (lbound < ctx->hole)
+            lbound = ctx->hole;
+
+        ubound = tg_complete_end(ctx->data, lbound, ctx->size);
+    } else {
+        result = tg_file_map(ctx, &file_stat);
+        if (result == TG_ERROR)
+            return TG_ERROR;
+
+        lbound = ctx->size;
+        ubound = ctx->size;
+        if (result == TG_FOUND) {
+            result = tg_file_search(ctx, &lbound, &ubound);
+            if (result == TG_ERROR)
+                return TG_ERROR;
+            else if (result == TG_NOT_FOUND)
+                lbound = ubound = tg_complete_end(ctx->data, ctx->hole, ctx->size);
+        }
+
+        ubound = tg_complete_end(ctx->data, lbound, ubound);
+    }
+
+    if (lbound < ubound) {
+        if (tg_file_output(ctx, lbound, ubound) == TG_ERROR)
+            return TG_ERROR;
+
+        retval = TG_FOUND;
+    }
+
+    memset(&state, 0, sizeof(state));
+    memcpy(state.magic, TG_STATE_MAGIC, sizeof(state.magic));
+
+    state.dev    = (uint64_t)file_stat.st_dev;
+    state.ino    = (uint64_t)file_stat.st_ino;
+    state.offset = (uint64_t)(ubound > lbound ? ubound : lbound);
+
+    tg_file_unmap(ctx);
+
+    if (tg_replace_file(ctx->state, &state, sizeof(state), NULL, 0) == TG_ERROR)
+        return TG_ERROR;
+
+    return retval;
+}
+
+/**
+ * Search first and last timestamps of mapped file
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if file has no timestamps
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_file_span(tg_context* ctx, tg_file* file)
+{
+    int      result;
+    size_t   start;
+    size_t   length;
+    tg_stamp stamp;
+
+    result = tg_forward_search(ctx->data, ctx->size, ctx->hole, ctx->size, &ctx->parser, &start, &length, &stamp);
+    if (result == TG_ERROR)
+        return TG_ERROR;
+    else if (result != TG_FOUND || tg_stamp_time(&ctx->parser, &stamp, &file->first) != TG_FOUND)
+        return TG_NOT_FOUND;
+
+    file->lbound = start;
+
+    result = tg_backward_search(ctx->data, ctx->size, ctx->size, start, &ctx->parser, &start, &length, &stamp);
+    if (result == TG_ERROR)
+        return TG_ERROR;
+    else if (result != TG_FOUND || tg_stamp_time(&ctx->parser, &stamp, &file->last) != TG_FOUND)
+        return TG_NOT_FOUND;
+
+    return TG_FOUND;
+}
+
+/**
+ * Compare rotation set files by first timestamp (qsort)
+ */
+static int tg_file_compare(const void* a, const void* b)
+{
+    const tg_file* fa = a;
+    const tg_file* fb = b;
+
+    if (fa->first != fb->first)
+        return (fa->first < fb->first ? -1 : 1);
+
+    return (fa->order < fb->order ? -1 : (fa->order > fb->order ? 1 : 0));
+}
+
+/**
+ * Search output range of mapped rotation set file (see tg_files_search)
+ * Identity of file is kept to find out if file is replaced before output
+ * Return TG_FOUND if file has strings after start (range may be empty)
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_files_range(tg_context* ctx, tg_file* file, const struct stat* file_stat)
+{
+    int result;
+
+    file->size   = ctx->size;
+    file->dev    = file_stat->st_dev;
+    file->ino    = file_stat->st_ino;
+    file->mtime  = file_stat->st_mtime;
+    file->lbound = 0;
+    file->ubound = 0;
+    file->point  = 0;
+    file->whole  = 0;
+
+    file->compressed = tg_file_compressed(ctx);
+    if (file->compressed != TG_COMPRESSED_NONE)
+        return tg_compressed_search(ctx, file, file_stat);
+
+    result = tg_file_span(ctx, file);
+    if (result != TG_FOUND)
+        return result;
+
+    if (file->last < ctx->start)
+        result = TG_NOT_FOUND;
+    else if (file->first >= ctx->stop)
+        file->ubound = file->lbound;
+    else if (file->first >= ctx->start && file->last < ctx->stop)
+        file->ubound = ctx->size;
+    else {
+        tg_index_open(ctx, file_stat);
+
+        result = tg_file_search(ctx, &file->lbound, &file->ubound);
+
+        tg_index_close(ctx);
+    }
+
+    return result;
+}
+
+/**
+ * Search output range of rotation set file (see tg_files_timegrep)
+ * Files wholly inside or outside of [start, stop) are not searched
+ * Return TG_FOUND if file has strings after start (range may be empty)
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_files_search(tg_context* ctx, tg_file* file)
+{
+    int         result;
+    struct stat file_stat;
+
+    ctx->filename = file->filename;
+
+    result = tg_file_map(ctx, &file_stat);
+    if (result == TG_FOUND)
+        result = tg_files_range(ctx, file, &file_stat);
+
+    tg_file_unmap(ctx);
+
+    return result;
+}
+
+/**
+ * Map rotation set file for output of range found by tg_files_search
+ * File replaced or changed after search (logrotate rename / create, copytruncate) is
+ * searched again in new mapping, so range never points to other content
+ * Return TG_FOUND on success (range may be empty), mapping must be unmapped
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_files_map(tg_context* ctx, tg_file* file, struct stat* file_stat)
+{
+    int result;
+
+    ctx->filename = file->filename;
+
+    result = tg_file_map(ctx, file_stat);
+    if (result != TG_FOUND)
+        return result;
+
+    if (
+        file->dev != file_stat->st_dev || file->ino != file_stat->st_ino ||
+        file->size != ctx->size || file->mtime != file_stat->st_mtime
+    )
+        file->result = tg_files_range(ctx, file, file_stat);
+
+    return file->result;
+}
+
+/**
+ * --jobs thread context
+ */
+typedef struct {
+    tg_context       ctx;        /* thread copy of working context           */
+    tg_file*         files;      /* files of rotation set                    */
+    size_t           count;      /* number of files                          */
+    size_t*          next;       /* next file to search (shared)             */
+    pthread_mutex_t* mutex;      /* next file lock                           */
+    int              result;     /* thread result                            */
+    int              error;      /* errno of thread on error                 */
+} tg_jobs;
+
+/**
+ * --jobs thread: search files of rotation set until all are taken
+ */
+static void* tg_files_thread(void* arg)
+{
+    size_t   i;
+    tg_jobs* jobs = arg;
+
+    jobs->result = TG_FOUND;
+
+    while (1) {
+        pthread_mutex_lock(jobs->mutex);
+        i = (*jobs->next)++;
+        pthread_mutex_unlock(jobs->mutex);
+
+        if (i >= jobs->count)
+            break;
+
+        jobs->files[i].result = tg_files_search(&jobs->ctx, jobs->files + i);
+        if (jobs->files[i].result == TG_ERROR) {
+            jobs->result = TG_ERROR;
+            jobs->error  = errno;
+
+            /* stop other threads */
+            pthread_mutex_lock(jobs->mutex);
+            *jobs->next = jobs->count;
+            pthread_mutex_unlock(jobs->mutex);
+
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Search files of rotation set on --jobs threads
+ * Every thread has own copy of context (parser, probes, mapping)
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_files_search_jobs(tg_context* ctx, tg_file* files, size_t count)
+{
+    int             result;
+    size_t          i;
+    size_t          next;
+    size_t          threads;
+    size_t          created;
+    pthread_t       thread[TG_JOBS_THREADS];
+    pthread_mutex_t mutex;
+    tg_jobs*        jobs;
+
+    threads = (ctx->jobs < count ? ctx->jobs : count);
+
+    jobs = calloc(threads, sizeof(tg_jobs));
+    if (jobs == NULL)
+        return TG_ERROR;
+
+    errno = pthread_mutex_init(&mutex, NULL);
+    if (errno != 0) {
+        free(jobs);
+        return TG_ERROR;
+    }
+
+    next = 0;
+    for (i = 0; i < threads; i++) {
+        jobs[i].ctx            = *ctx;
+        jobs[i].ctx.fd         = -1;
+        jobs[i].ctx.data       = MAP_FAILED;
+        jobs[i].ctx.index_data = MAP_FAILED;
+        jobs[i].files          = files;
+        jobs[i].count          = count;
+        jobs[i].next           = &next;
+        jobs[i].mutex          = &mutex;
+    }
+
+    result = TG_FOUND;
+    for (created = 0; created < threads; created++) {
+        errno = pthread_create(&thread[created], NULL, tg_files_thread, &jobs[created]);
+        if (errno != 0) {
+            result = TG_ERROR;
+
+            pthread_mutex_lock(&mutex);
+            next = count;
+            pthread_mutex_unlock(&mutex);
+
+            break;
+        }
+    }
+
+    for (i = 0; i < created; i++)
+        pthread_join(thread[i], NULL);
+
+    for (i = 0; result != TG_ERROR && i < created; i++)
+        if (jobs[i].result == TG_ERROR) {
+            errno  = jobs[i].error;
+            result = TG_ERROR;
+        }
+
+    pthread_mutex_destroy(&mutex);
+    free(jobs);
+
+    return result;
+}
+
+/**
+ * --merge cursor of file
+ * Record is string with datetime and following strings without datetime
+ */
+typedef struct {
+    const char* data;        /* mapped file                              */
+    size_t      size;        /* size of mapped file                      */
+    size_t      start;       /* current record start or ubound           */
+    size_t      ubound;      /* output range end                         */
+    size_t      order;       /* order of file in rotation set            */
+    tg_stamp    stamp;       /* current record datetime                  */
+} tg_merge;
+
+/**
+ * Move merge cursor to first record starting from position
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_merge_seek(tg_parser* parser, tg_merge* merge, size_t position)
+{
+    int    result;
+    size_t length;
+
+    result = tg_forward_search(merge->data, merge->size, position, merge->ubound, parser, &merge->start, &length, &merge->stamp);
+    if (result == TG_ERROR)
+        return TG_ERROR;
+    else if (result != TG_FOUND)
+        merge->start = merge->ubound;
+
+    return TG_FOUND;
+}
+
+/**
+ * Compare current records of merge cursors by datetime and order of files
+ * Return negative or positive value if a is before or after b
+ */
+static int tg_merge_compare(tg_parser* parser, const tg_merge* a, const tg_merge* b)
+{
+    int    result;
+    time_t timestamp;
+
+    if (a->stamp.key != NULL && b->stamp.key != NULL)
+        result = memcmp(a->stamp.key, b->stamp.key, parser->lexical);
+    else if (a->stamp.key == NULL && b->stamp.key == NULL)
+        result = (a->stamp.timestamp < b->stamp.timestamp ? -1 : (a->stamp.timestamp > b->stamp.timestamp ? 1 : 0));
+    else if (tg_stamp_time(parser, (a->stamp.key != NULL ? &a->stamp : &b->stamp), &timestamp) != TG_FOUND)
+        result = 0;
+    else if (a->stamp.key != NULL)
+        result = (timestamp < b->stamp.timestamp ? -1 : (timestamp > b->stamp.timestamp ? 1 : 0));
+    else
+        result = (a->stamp.timestamp < timestamp ? -1 : (a->stamp.timestamp > timestamp ? 1 : 0));
+
+    if (result == 0)
+        result = (a->order < b->order ? -1 : 1);
+
+    return result;
+}
+
+/**
+ * Sift down merge cursor at i of min heap
+ */
+static void tg_merge_heapify(tg_parser* parser, const tg_merge* merge, size_t* heap, size_t count, size_t i)
+{
+    size_t child;
+    size_t root;
+
+    root = heap[i];
+    while ((child = 2 * i + 1) < count) {
+        if (child + 1 < count && tg_merge_compare(parser, merge + heap[child + 1], merge + heap[child]) < 0)
+            child++;
+
+        if (tg_merge_compare(parser, merge + root, merge + heap[child]) < 0)
+            break;
+
+        heap[i] = heap[child];
+        i       = child;
+    }
+
+    heap[i] = root;
+}
+
+/**
+ * Print found ranges of rotation set merged by datetime (--merge)
+ * Heap of per file cursors is merged record by record, records of the same file
+ * in a row are printed with single write, so memory use is O(files)
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_files_merge(tg_context* ctx, tg_file* files, size_t count)
+{
+    int         result;
+    size_t      i;
+    size_t      mapped;
+    size_t      heaped;
+    size_t      start;
+    size_t      length;
+    size_t*     heap;
+    tg_merge*   merge;
+    tg_merge*   top;
+    tg_merge*   next;
+    struct stat file_stat;
+
+    merge = calloc(count + 1, sizeof(tg_merge));
+    heap  = calloc(count + 1, sizeof(size_t));
+    if (merge == NULL || heap == NULL) {
+        free(merge);
+        free(heap);
+        return TG_ERROR;
+    }
+
+    result = TG_FOUND;
+    mapped = 0;
+    for (i = 0; result != TG_ERROR && i < count; i++) {
+        if (files[i].result != TG_FOUND || files[i].lbound == files[i].ubound)
+            continue;
+
+        if (files[i].compressed == TG_COMPRESSED_NONE)
+            result = tg_files_map(ctx, files + i, &file_stat);
+
+        if (files[i].compressed != TG_COMPRESSED_NONE) {
+            errno = 0;
+            fprintf(stderr, gettext("%s Merge of compressed file '%s' is not supported\n"), gettext("ERROR:"), files[i].filename);
+            result = TG_ERROR;
+        } else if (result == TG_FOUND && files[i].lbound < files[i].ubound) {
+            top = merge + mapped++;
+
+            /* mapping is owned by cursor */
+            top->data   = ctx->data;
+            top->size   = ctx->size;
+            top->ubound = files[i].ubound;
+            top->order  = files[i].order;
+            ctx->data   = MAP_FAILED;
+
+            result = tg_merge_seek(&ctx->parser, top, files[i].lbound);
+        }
+
+        tg_file_unmap(ctx);
+    }
+
+    /* heap of cursors with records, smallest record at root */
+    heaped = 0;
+    for (i = 0; result != TG_ERROR && i < mapped; i++) {
+        if (merge[i].start < merge[i].ubound)
+            heap[heaped++] = i;
+    }
+
+    for (i = heaped / 2; i > 0; i--)
+        tg_merge_heapify(&ctx->parser, merge, heap, heaped, i - 1);
+
+    while (result != TG_ERROR && heaped != 0) {
+        top   = merge + heap[0];
+        start = top->start;
+
+        /* records in a row while before records of other files */
+        next = NULL;
+        if (heaped > 1)
+            next = merge + heap[(heaped > 2 && tg_merge_compare(&ctx->parser, merge + heap[2], merge + heap[1]) < 0) ? 2 : 1];
+
+        if (next == NULL)
+            top->start = top->ubound;
+        else
+            do {
+                length = tg_get_string_end(top->data, top->size, top->start);
+                if (tg_merge_seek(&ctx->parser, top, top->start + length) == TG_ERROR) {
+                    result = TG_ERROR;
+                    break;
+                }
+            } while (top->start < top->ubound && tg_merge_compare(&ctx->parser, top, next) < 0);
+
+        if (result == TG_ERROR || tg_write(STDOUT_FILENO, top->data + start, top->start - start) == TG_ERROR) {
+            result = TG_ERROR;
+            break;
+        }
+
+        /* separate last string of file without newline from next record */
+        if (top->start == top->size && top->data[top->size - 1] != '\n' && tg_write(STDOUT_FILENO, "\n", 1) == TG_ERROR) {
+            result = TG_ERROR;
+            break;
+        }
+
+        if (top->start >= top->ubound)
+            heap[0] = heap[--heaped];
+
+        if (heaped != 0)
+            tg_merge_heapify(&ctx->parser, merge, heap, heaped, 0);
+    }
+
+    for (i = 0; i < mapped; i++)
+        munmap((void*)merge[i].data, merge[i].size);
+
+    free(merge);
+    free(heap);
+
+    return result;
+}
+
+/**
+ * Timegrep of rotation set as single timeline
+ * Output ranges of files are searched first (on --jobs threads), only first and
+ * last timestamps are read from files wholly inside or outside of [start, stop).
+ * Files are printed in chronological order regardless of arguments order, search
+ * results are only ranges, so memory use does not depend on output size
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_files_timegrep(tg_context* ctx, char* filenames[], size_t count)
+{
+    int         result;
+    int         retval;
+    size_t      i;
+    tg_file*    files;
+    struct stat file_stat;
+
+    files = calloc(count + 1, sizeof(tg_file));
+    if (files == NULL)
+        return TG_ERROR;
+
+    for (i = 0; i < count; i++) {
+        files[i].filename = filenames[i];
+        files[i].order    = i;
+        files[i].result   = TG_NOT_FOUND;
+    }
+
+    if (ctx->jobs > 1 && count > 1)
+        result = tg_files_search_jobs(ctx, files, count);
+    else {
+        result = TG_FOUND;
+        for (i = 0; result != TG_ERROR && i < count; i++) {
+            files[i].result = tg_files_search(ctx, files + i);
+            if (files[i].result == TG_ERROR)
+                result = TG_ERROR;
+        }
+    }
+
+    if (result == TG_ERROR)
+        goto ERROR;
+
+    qsort(files, count, sizeof(tg_file), tg_file_compare);
+
+    /* compressed file range is only known after output */
+    retval = TG_NOT_FOUND;
+    for (i = 0; i < count; i++)
+        if (files[i].result == TG_FOUND && (files[i].compressed == TG_COMPRESSED_NONE || ctx->merge != 0))
+            retval = TG_FOUND;
+
+    if (ctx->merge != 0) {
+        if (tg_files_merge(ctx, files, count) == TG_ERROR)
+            goto ERROR;
+
+        count = 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (files[i].result != TG_FOUND || files[i].lbound == files[i].ubound)
+            continue;
+
+        result = tg_files_map(ctx, files + i, &file_stat);
+        if (result == TG_FOUND && files[i].compressed != TG_COMPRESSED_NONE) {
+            result = tg_compressed_output(ctx, files + i, &file_stat);
+            if (result == TG_FOUND)
+                retval = TG_FOUND;
+        }
+        else if (result == TG_FOUND && files[i].lbound < files[i].ubound) {
+            result = tg_file_output(ctx, files[i].lbound, files[i].ubound);
+            if (result != TG_ERROR)
+                retval = TG_FOUND;
+
+            /* terminate last string of file without newline as tg_files_merge does */
+            if (
+                result != TG_ERROR && files[i].ubound == ctx->size &&
+                ctx->data[ctx->size - 1] != '\n' && write(STDOUT_FILENO, "\n", 1) == -1
+            )
+                result = TG_ERROR;
+        }
+
+        tg_file_unmap(ctx);
+
+        if (result == TG_ERROR)
+            goto ERROR;
+    }
+
+    free(files);
+
+    return retval;
+
+ERROR:
+
+    free(files);
+
+    return TG_ERROR;
+}
+
+/**
+ * Append copy of filename to list
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_filenames_add(tg_filenames* files, const char* filename)
+{
+    char** filenames;
+
+    if (files->count == files->alloc) {
+        files->alloc = (files->alloc == 0 ? 64 : files->alloc * 2);
 
+        filenames = realloc(files->filename, files->alloc * sizeof(char*));
+        if (filenames == NULL)
             return TG_ERROR;
+
+        files->filename = filenames;
+    }
+
+    files->filename[files->count] = tg_filename(filename, "");
+    if (files->filename[files->count] == NULL)
+        return TG_ERROR;
+
+    files->count++;
+
+    return TG_FOUND;
+}
+
+/**
+ * Free list of files
+ */
+static void tg_filenames_free(tg_filenames* files)
+{
+    size_t i;
+
+    for (i = 0; i < files->count; i++)
+        free(files->filename[i]);
+
+    free(files->filename);
+
+    memset(files, 0, sizeof(*files));
+}
+
+/**
+ * Compare filenames (qsort)
+ */
+static int tg_filenames_compare(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/**
+ * Append filename to list or files of directory with --recursive
+ * Directory entries are added in name order, symbolic links to directories are not followed
+ * Regular files of directories modified before mtime are skipped (mtime is upper bound of file timestamps),
+ * files given explicitly are always searched
+ * Nested directories that can not be opened are skipped with warning
+ * Return TG_FOUND on success
+ * Retrun TG_ERROR on error, errno is set
+ */
+static int tg_files_collect(tg_context* ctx, tg_filenames* files, const char* filename, const time_t* mtime, int nested)
+{
+    int            result;
+    DIR*           dir;
+    struct dirent* entry;
+    struct stat    file_stat;
+    char*          path;
+    size_t         length;
+    size_t         first;
+
+    /* errors of not nested filenames are reported on open */
+    if ((nested == 0 ? stat(filename, &file_stat) : lstat(filename, &file_stat)) == -1)
+        return (nested == 0 ? tg_filenames_add(files, filename) : TG_FOUND);
+    else if (nested != 0 && S_ISLNK(file_stat.st_mode) && (stat(filename, &file_stat) == -1 || S_ISDIR(file_stat.st_mode)))
+        return TG_FOUND;
+
+    if (S_ISDIR(file_stat.st_mode) == 0 || ctx->recursive == 0) {
+        if (nested != 0 && S_ISREG(file_stat.st_mode) && mtime != NULL && file_stat.st_mtime < *mtime)
+            return TG_FOUND;
+        else if (nested != 0 && S_ISREG(file_stat.st_mode) == 0)
+            return TG_FOUND;
+
+        return tg_filenames_add(files, filename);
+    }
+
+    dir = opendir(filename);
+    if (dir == NULL) {
+        if (nested != 0) {
+            fprintf(stderr, gettext("%s Skip directory '%s': %s\n"), gettext("WARNING:"), filename, strerror(errno));
+            return TG_FOUND;
         }
 
-        result = tg_strptime(match, parser->format, parser->format_tz, timestamp);
+        fprintf(stderr, gettext("%s Can not open directory '%s': %s\n"), gettext("ERROR:"), filename, strerror(errno));
+        errno = 0;
+        return TG_ERROR;
+    }
 
-        pcre_free_substring(match);
+    result = TG_FOUND;
+    first  = files->count;
+    length = strlen(filename);
+
+    while (result == TG_FOUND && (entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        path = malloc(length + strlen(entry->d_name) + 2);
+        if (path == NULL) {
+            result = TG_ERROR;
+            break;
+        }
+
+        memcpy(path, filename, length);
+        path[length] = '/';
+        strcpy(path + length + 1, entry->d_name);
+
+        result = tg_files_collect(ctx, files, path, mtime, 1);
+
+        free(path);
     }
 
+    closedir(dir);
+
+    if (result == TG_FOUND)
+        qsort(files->filename + first, files->count - first, sizeof(char*), tg_filenames_compare);
+
     return result;
 }
 
 /**
- * Search string boundaries in multiline data starting from position
+ * --verify-sorted thread context
+ */
+typedef struct {
+    const tg_context* ctx;        /* working context (read only)              */
+    tg_parser         parser;     /* thread copy of datetime parser           */
+    size_t            lbound;     /* first string start of slice             */
+    size_t            ubound;     /* first string start after slice           */
+    int               result;     /* thread result                            */
+    int               error;      /* errno of thread on error                 */
+    int               found;      /* slice has timestamped strings            */
+    size_t            offset;     /* first timestamped string start           */
+    tg_stamp          first;      /* first timestamp of slice                 */
+    tg_stamp          last;       /* last timestamp of slice                  */
+    tg_inversion*     inversion;  /* inversions found in slice                */
+    size_t            count;      /* number of inversions                     */
+    size_t            alloc;      /* allocated inversions                     */
+} tg_verify;
+
+/**
+ * Check two consecutive timestamps and record inversion if timestamp is
+ * less than previous by more than tolerance
  * Return TG_FOUND on success
- * Return TG_NOT_FOUND if newline delimeter exactly in position
- * Return TG_NULL if nothing found (whole data is single string without delimeter)
+ * Return TG_ERROR on memory allocation error
  */
-static int tg_get_string(
-    const char* data,       /* multiline data                                 */
-    size_t      size,       /* size of multiline data                         */
-    size_t      position,   /* position to start search                       */
-    size_t*     start,      /* result string start                            */
-    size_t*     length      /* result string length (not including delimeter) */
-)
+static int tg_verify_pair(tg_verify* verify, const tg_stamp* previous, const tg_stamp* stamp, size_t offset)
 {
-    char* nl;
+    time_t        ptime;
+    time_t        stime;
+    tg_inversion* inversion;
 
-    if (data[position] == '\n')
-        return TG_NOT_FOUND;
+    /* lexicographic fast path */
+    if (stamp->key != NULL && previous->key != NULL && memcmp(stamp->key, previous->key, verify->parser.lexical) >= 0)
+        return TG_FOUND;
 
-    nl = memrchr(data, '\n', position);
-    if (nl == NULL)
-        *start = 0;
-    else
-        *start = (size_t)(nl - data) + 1;
+    if (tg_stamp_time(&verify->parser, previous, &ptime) != TG_FOUND || tg_stamp_time(&verify->parser, stamp, &stime) != TG_FOUND)
+        return TG_FOUND;
 
-    nl = memchr(data + position, '\n', size - position);
-    if (nl == NULL)
-        *length = size - (*start);
-    else
-        *length = (size_t)(nl - data) - (*start);
+    if (stime >= ptime || ptime - stime <= verify->ctx->tolerance)
+        return TG_FOUND;
 
-    if ((*length) == size)
-        return TG_NULL;
+    if (verify->count == verify->alloc) {
+        verify->alloc = (verify->alloc == 0 ? 64 : verify->alloc * 2);
+
+        inversion = realloc(verify->inversion, verify->alloc * sizeof(tg_inversion));
+        if (inversion == NULL)
+            return TG_ERROR;
+
+        verify->inversion = inversion;
+    }
+
+    inversion = verify->inversion + verify->count;
+    verify->count++;
+
+    inversion->offset    = offset;
+    inversion->timestamp = stime;
+    inversion->previous  = ptime;
 
     return TG_FOUND;
 }
 
 /**
- * Forward search any timestamp in multiline data starting from position to ubound
- * Return TG_FOUND on success
- * Return TG_NOT_FOUND if nothing found from position to size
- * Return TG_NULL if whole data is single string
+ * --verify-sorted thread: parse every string starting in slice
+ */
+static void* tg_verify_thread(void* arg)
+{
+    int         result;
+    size_t      position;
+    size_t      end;
+    const char* nl;
+    tg_stamp    stamp;
+    tg_verify*  verify = arg;
+    const char* data   = verify->ctx->data;
+    size_t      size   = verify->ctx->size;
+
+    verify->result = TG_FOUND;
+
+    position = verify->lbound;
+    while (position < verify->ubound) {
+        nl  = memchr(data + position, '\n', size - position);
+        end = (nl == NULL ? size : (size_t)(nl - data));
+
+        result = tg_get_timestamp(data + position, end - position, &verify->parser, &stamp);
+        if (result == TG_ERROR) {
+            verify->result = TG_ERROR;
+            verify->error  = errno;
+            break;
+        } else if (result == TG_FOUND) {
+            if (verify->found == 0) {
+                verify->found  = 1;
+                verify->offset = position;
+                verify->first  = stamp;
+            } else if (tg_verify_pair(verify, &verify->last, &stamp, position) == TG_ERROR) {
+                verify->result = TG_ERROR;
+                verify->error  = ENOMEM;
+                break;
+            }
+
+            verify->last = stamp;
+        }
+
+        position = end + 1;
+    }
+
+    return NULL;
+}
+
+/**
+ * Print inversion found by --verify-sorted
+ */
+static void tg_verify_print(const tg_context* ctx, const tg_inversion* inversion)
+{
+    time_t    local;
+    struct tm tm;
+    char      timestamp[32];
+    char      previous[32];
+
+    local = inversion->timestamp + TG_TIMEZONE;
+    gmtime_r(&local, &tm);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm);
+
+    local = inversion->previous + TG_TIMEZONE;
+    gmtime_r(&local, &tm);
+    strftime(previous, sizeof(previous), "%Y-%m-%d %H:%M:%S", &tm);
+
+    printf(gettext("%s:%lu: %s after %s\n"), ctx->filename, (unsigned long)inversion->offset, timestamp, previous);
+}
+
+/**
+ * Verify mapped file is sorted by timestamp (--verify-sorted)
+ * File is split to per thread slices aligned to string starts, every string is
+ * parsed and every timestamp less than previous by more than tolerance is printed
+ * Return TG_FOUND if file is sorted
+ * Return TG_NOT_FOUND if inversions found
  * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
  */
-static int tg_forward_search(
-    const char*      data,       /* multiline data                                 */
-    size_t           size,       /* size of multiline data                         */
-    size_t           position,   /* position to start search                       */
-    size_t           ubound,     /* upper bound position to search                 */
-    const tg_parser* parser,     /* datetime parser context                        */
-    size_t*          start,      /* result string start                            */
-    size_t*          length,     /* result string length (not including delimeter) */
-    time_t*          timestamp   /* result timestamp                               */
-)
+static int tg_file_verify(tg_context* ctx)
 {
-    int    result;
-    size_t rstart;
-    size_t rlength;
-    time_t rtimestamp;
+    int        result;
+    long       cpus;
+    size_t     threads;
+    size_t     i;
+    size_t     bound;
+    size_t     created;
+    const char* nl;
+    pthread_t  thread[TG_VERIFY_THREADS];
+    tg_verify* verify;
+    tg_verify  boundary;
+    tg_verify* previous;
+
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (cpus < 1 ? 1 : (size_t)cpus);
+    if (threads > TG_VERIFY_THREADS)
+        threads = TG_VERIFY_THREADS;
+    if (threads > ctx->size / TG_VERIFY_SLICE + 1)
+        threads = ctx->size / TG_VERIFY_SLICE + 1;
+
+    verify = calloc(threads, sizeof(tg_verify));
+    if (verify == NULL)
+        return TG_ERROR;
 
-    result = TG_NOT_FOUND;
-    while (result == TG_NOT_FOUND && position < ubound) {
-        result = tg_get_string(data, size, position, &rstart, &rlength);
-        if (result == TG_FOUND) {
-            result = tg_get_timestamp(data + rstart, rlength, parser, &rtimestamp);
-            if (result == TG_NOT_FOUND)
-                position = rstart + rlength + 1;
-        } else if (result == TG_NULL)
-            break;
+    /* slices start at first string starting at or after boundary */
+    for (i = 0; i < threads; i++) {
+        bound = ctx->hole + (ctx->size - ctx->hole) / threads * i;
+        if (i != 0 && bound != 0) {
+            nl    = memchr(ctx->data + bound - 1, '\n', ctx->size - bound + 1);
+            bound = (nl == NULL ? ctx->size : (size_t)(nl - ctx->data) + 1);
+        }
 
-        position++;
+        verify[i].ctx    = ctx;
+        verify[i].parser = ctx->parser;
+        verify[i].lbound = bound;
+
+        if (i != 0)
+            verify[i - 1].ubound = (bound > verify[i - 1].lbound ? bound : verify[i - 1].lbound);
     }
 
-    if (result == TG_FOUND) {
-        *start     = rstart;
-        *length    = rlength;
-        *timestamp = rtimestamp;
+    verify[threads - 1].ubound = ctx->size;
+
+    result = TG_FOUND;
+    for (created = 0; created < threads; created++) {
+        errno = pthread_create(&thread[created], NULL, tg_verify_thread, &verify[created]);
+        if (errno != 0) {
+            result = TG_ERROR;
+            break;
+        }
+    }
+
+    for (i = 0; i < created; i++)
+        pthread_join(thread[i], NULL);
+
+    for (i = 0; result != TG_ERROR && i < created; i++)
+        if (verify[i].result == TG_ERROR) {
+            errno  = verify[i].error;
+            result = TG_ERROR;
+        }
+
+    /* inversions in file order including slice boundaries */
+    memset(&boundary, 0, sizeof(boundary));
+    boundary.ctx    = ctx;
+    boundary.parser = ctx->parser;
+
+    previous = NULL;
+    for (i = 0; result != TG_ERROR && i < threads; i++) {
+        if (verify[i].found == 0)
+            continue;
+
+        if (previous != NULL) {
+            boundary.count = 0;
+            if (tg_verify_pair(&boundary, &previous->last, &verify[i].first, verify[i].offset) == TG_ERROR) {
+                errno  = ENOMEM;
+                result = TG_ERROR;
+                break;
+            }
+
+            if (boundary.count != 0) {
+                tg_verify_print(ctx, boundary.inversion);
+                result = TG_NOT_FOUND;
+            }
+        }
+
+        for (bound = 0; bound < verify[i].count; bound++)
+            tg_verify_print(ctx, verify[i].inversion + bound);
+
+        if (verify[i].count != 0)
+            result = TG_NOT_FOUND;
+
+        previous = verify + i;
     }
 
+    for (i = 0; i < threads; i++)
+        free(verify[i].inversion);
+
+    free(boundary.inversion);
+    free(verify);
+
     return result;
 }
 
 /**
- * Binary search timestamp in multiline data
+ * --jobs stream pipeline block of complete strings
+ */
+typedef struct {
+    char*  data;       /* strings of stream                                */
+    size_t size;       /* allocated size                                   */
+    size_t length;     /* strings length                                   */
+    size_t start;      /* first string not less than start or length       */
+    size_t stop;       /* first string not less than stop or length        */
+    int    continued;  /* block starts with rest of long string            */
+    int    state;      /* block state                                      */
+} tg_block;
+
+/**
+ * --jobs stream pipeline block states
+ */
+static const int TG_BLOCK_FREE   = 0;   /* may be filled by reader */
+static const int TG_BLOCK_FILLED = 1;   /* may be taken by worker  */
+static const int TG_BLOCK_TAKEN  = 2;   /* is parsed by worker     */
+static const int TG_BLOCK_PARSED = 3;   /* may be written          */
+
+/**
+ * --jobs stream pipeline: reader thread fills ring of blocks in stream order, worker
+ * threads parse blocks in any order and main thread writes blocks in stream order
+ */
+typedef struct {
+    const tg_reader* reader;     /* stream data source                        */
+    int              fd;         /* stream descriptor to poll                 */
+    size_t           chunk;      /* io chunk size                             */
+    size_t           max;        /* maximum string length or 0                */
+    tg_block*        blocks;     /* ring of blocks                            */
+    size_t           count;      /* ring size                                 */
+    size_t           filled;     /* blocks filled by reader                   */
+    size_t           taken;      /* blocks taken by workers                   */
+    size_t           written;    /* blocks written                            */
+    char*            tail;       /* incomplete string after last block        */
+    size_t           tail_size;  /* allocated size of tail                    */
+    size_t           tail_length;/* length of tail                            */
+    int              continued;  /* tail is rest of long string               */
+    int              end;        /* end of stream is read                     */
+    int              eof;        /* reader finished (end of stream or error)  */
+    int              cancel;     /* stop pipeline (stop found or error)       */
+    int              result;     /* pipeline result                           */
+    int              error;      /* errno of pipeline on error                */
+    pthread_mutex_t  mutex;      /* pipeline lock                             */
+    pthread_cond_t   cond;       /* pipeline state is changed                 */
+} tg_pipeline;
+
+/**
+ * --jobs stream pipeline worker context
+ */
+typedef struct {
+    tg_context   ctx;            /* thread copy of working context            */
+    tg_pipeline* pipeline;       /* shared pipeline                           */
+} tg_worker;
+
+/**
+ * Stop pipeline on error (pipeline must be locked)
+ */
+static void tg_pipeline_error(tg_pipeline* pipeline, int error)
+{
+    if (pipeline->result != TG_ERROR) {
+        pipeline->result = TG_ERROR;
+        pipeline->error  = error;
+    }
+
+    pipeline->cancel = 1;
+
+    pthread_cond_broadcast(&pipeline->cond);
+}
+
+/**
+ * Fill block with complete strings of stream (incomplete string is kept in tail)
+ * String longer than max is cut after max bytes, so block size is bounded, and rest of
+ * string starts next block (see tg_read_stream_string)
+ * Block with complete strings is passed before TG_STREAM_BLOCK is filled if stream has no
+ * data to read now (slow producer, tail -f), so string after stop is not waited for
  * Return TG_FOUND on success
- * Return TG_NOT_FOUND if nothing found
- * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ * Return TG_NOT_FOUND on end of stream
+ * Retrun TG_ERROR on error, errno is set
  */
-static int tg_binary_search(
-    const char*      data,      /* multiline data                            */
-    size_t           size,      /* size of multiline data                    */
-    const tg_parser* parser,    /* datetime parser context                   */
-    time_t           search,    /* timestamp to search                       */
-    size_t           lbound,    /* recommended lower bound postion to search */
-    size_t*          position   /* result string start                       */
-)
+static int tg_pipeline_fill(tg_pipeline* pipeline, tg_block* block)
 {
-    int    retval;
-    int    result;
-    size_t middle;
-    size_t ubound;
-    time_t timestamp;
-    size_t start;
-    size_t length;
+    int           state;
+    int           open;
+    char*         nl;
+    char*         buffer;
+    ssize_t       actual;
+    size_t        size;
+    size_t        line;
+    size_t        position;
+    struct pollfd fds;
+
+    if (pipeline->end != 0)
+        return TG_NOT_FOUND;
 
-    retval = TG_NOT_FOUND;
-    ubound = size;
-    middle = lbound + (ubound - lbound) / 2;
+    block->length    = 0;
+    block->continued = pipeline->continued;
 
-    while (lbound != middle) {
-        result = tg_forward_search(
-            data,
-            size,
-            middle,
-            ubound,
-            parser,
-            &start,
-            &length,
-            &timestamp
-        );
+    if (pipeline->tail_length > 0) {
+        if (block->size < pipeline->tail_length) {
+            buffer = realloc(block->data, pipeline->tail_length);
+            if (buffer == NULL)
+                return TG_ERROR;
 
-        if (result == TG_FOUND) {
-            if (timestamp < search) {
-                lbound = start + length;
-                middle = ubound;
-                if (lbound != ubound)
-                    lbound++;
-            } else if (timestamp >= search) {
-                retval    = TG_FOUND;
-                ubound    = start;
-                middle    = ubound;
-                *position = start;
+            block->data = buffer;
+            block->size = pipeline->tail_length;
+        }
+
+        memcpy(block->data, pipeline->tail, pipeline->tail_length);
+
+        block->length         = pipeline->tail_length;
+        pipeline->tail_length = 0;
+    }
+
+    /* last string starts at line or is rest of long string if open */
+    line     = 0;
+    open     = block->continued;
+    position = 0;
+
+    while (1) {
+        nl = memrchr(block->data + position, '\n', block->length - position);
+        if (nl != NULL) {
+            line = (size_t)(nl - block->data) + 1;
+            open = 0;
+        }
+
+        if (open != 0 && block->length >= TG_STREAM_BLOCK) {
+            size = block->length;
+            break;
+        } else if (open == 0 && pipeline->max != 0 && block->length - line > pipeline->max) {
+            size = line + pipeline->max;
+            break;
+        } else if (block->length >= TG_STREAM_BLOCK && line > 0) {
+            size = line;
+            break;
+        } else if (line > 0) {
+            fds.fd      = pipeline->fd;
+            fds.events  = POLLIN;
+            fds.revents = 0;
+
+            if (poll(&fds, 1, 0) == 0) {
+                size = line;
+                break;
             }
-        } else if (result == TG_NOT_FOUND)
-            ubound = middle;
-        else if (result == TG_ERROR)
+        }
+
+        if (block->size - block->length < pipeline->chunk) {
+            size = (block->size < TG_STREAM_BLOCK ? TG_STREAM_BLOCK : block->size * 2) + pipeline->chunk;
+
+            buffer = realloc(block->data, size);
+            if (buffer == NULL)
+                return TG_ERROR;
+
+            block->data = buffer;
+            block->size = size;
+        }
+
+        /* reader may wait for data forever, so it is cancelled while stream is read */
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &state);
+        actual = pipeline->reader->read(pipeline->reader->source, block->data + block->length, pipeline->chunk);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &state);
+
+        if (actual == -1)
             return TG_ERROR;
-        else
+
+        /* incomplete string at end of stream is dropped as by tg_stream_filter */
+        if (actual == 0) {
+            pipeline->end = 1;
+
+            size = (open != 0 ? block->length : line);
+            break;
+        }
+
+        position       = block->length;
+        block->length += (size_t)actual;
+    }
+
+    if (pipeline->tail_size < block->length - size) {
+        buffer = realloc(pipeline->tail, block->length - size);
+        if (buffer == NULL)
+            return TG_ERROR;
+
+        pipeline->tail      = buffer;
+        pipeline->tail_size = block->length - size;
+    }
+
+    pipeline->tail_length = block->length - size;
+    pipeline->continued   = (size > 0 && block->data[size - 1] != '\n');
+
+    memcpy(pipeline->tail, block->data + size, pipeline->tail_length);
+
+    block->length = size;
+
+    return (size > 0 ? TG_FOUND : TG_NOT_FOUND);
+}
+
+/**
+ * --jobs stream pipeline reader thread
+ */
+static void* tg_pipeline_reader(void* arg)
+{
+    int          state;
+    int          result;
+    tg_block*    block;
+    tg_pipeline* pipeline = arg;
+
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &state);
+
+    while (1) {
+        pthread_mutex_lock(&pipeline->mutex);
+
+        while (pipeline->cancel == 0 && pipeline->filled - pipeline->written == pipeline->count)
+            pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+
+        block = pipeline->blocks + pipeline->filled % pipeline->count;
+
+        result = pipeline->cancel;
+        pthread_mutex_unlock(&pipeline->mutex);
+
+        if (result != 0)
             break;
 
-        middle = lbound + (middle - lbound) / 2;
+        result = tg_pipeline_fill(pipeline, block);
+
+        pthread_mutex_lock(&pipeline->mutex);
+
+        if (result == TG_ERROR)
+            tg_pipeline_error(pipeline, errno);
+        else if (result == TG_FOUND) {
+            block->state = TG_BLOCK_FILLED;
+            pipeline->filled++;
+
+            pthread_cond_broadcast(&pipeline->cond);
+        }
+
+        pthread_mutex_unlock(&pipeline->mutex);
+
+        if (result != TG_FOUND)
+            break;
     }
 
-    return retval;
+    pthread_mutex_lock(&pipeline->mutex);
+    pipeline->eof = 1;
+    pthread_cond_broadcast(&pipeline->cond);
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    return NULL;
 }
 
 /**
- * File timegrep with binary search
+ * Search first strings not less than start and stop in block
+ * Stream is assumed monotone as by tg_stream_filter: block with last datetime less
+ * than start is skipped and search is done when start is found before last datetime
+ * less than stop
  * Return TG_FOUND on success
- * Return TG_NOT_FOUND if nothing found
  * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
  */
-static int tg_file_timegrep(const tg_context* ctx)
+static int tg_pipeline_parse(tg_context* ctx, tg_block* block)
 {
-    int     result;
-    size_t  lbound;
-    size_t  ubound;
-    ssize_t actual;
-    size_t  length;
-    size_t  lbound_aligned;
-    size_t  ubound_aligned;
-    size_t  page_size = (size_t)getpagesize();
-    size_t  page_mask = ~(page_size - 1);
-
-    result = tg_binary_search(
-        ctx->data,
-        ctx->size,
-        &ctx->parser,
-        ctx->start,
-        0,
-        &lbound
-    );
-
-    if (result != TG_FOUND)
-        return result;
+    int      result;
+    int      before;
+    size_t   first;
+    size_t   lbound;
+    size_t   length;
+    tg_stamp stamp;
+    char*    nl;
+
+    block->start = block->length;
+    block->stop  = block->length;
+
+    /* rest of long string is not parsed */
+    first = 0;
+    if (block->continued != 0) {
+        nl    = memchr(block->data, '\n', block->length);
+        first = (nl == NULL ? block->length : (size_t)(nl - block->data) + 1);
+    }
 
-    result = tg_binary_search(
-        ctx->data,
-        ctx->size,
-        &ctx->parser,
-        ctx->stop,
-        lbound,
-        &ubound
-    );
+    if (first == block->length)
+        return TG_FOUND;
 
+    result = tg_backward_search(block->data, block->length, block->length, first, &ctx->parser, &lbound, &length, &stamp);
     if (result == TG_ERROR)
-        return result;
-    else if (result == TG_NOT_FOUND)
-        ubound = ctx->size;
+        return TG_ERROR;
+    else if (result == TG_NOT_FOUND || (result == TG_FOUND && tg_compare(&ctx->parser, &stamp, ctx->start, ctx->start_key) < 0))
+        return TG_FOUND;
 
-    lbound_aligned = lbound & page_mask;
-    while (lbound < ubound) {
-        length = ctx->chunk;
-        if (lbound + length >= ubound)
-            length = ubound - lbound;
+    before = (result == TG_FOUND && tg_compare(&ctx->parser, &stamp, ctx->stop, ctx->stop_key) < 0);
 
-        actual = write(STDOUT_FILENO, ctx->data + lbound, length);
-        if (actual == -1)
-            return TG_ERROR;
+    /* last string may be cut long string */
+    lbound = first;
+    while (lbound < block->length) {
+        nl     = memchr(block->data + lbound, '\n', block->length - lbound);
+        length = (nl == NULL ? block->length : (size_t)(nl - block->data)) - lbound;
 
-        lbound += (size_t)actual;
+        result = tg_get_timestamp(block->data + lbound, length, &ctx->parser, &stamp);
+        if (result == TG_ERROR)
+            return TG_ERROR;
 
-        if (lbound_aligned + ctx->chunk < lbound) {
-            ubound_aligned = lbound & page_mask;
-            if (lbound_aligned < ubound_aligned)
-                madvise((void*)(ctx->data + lbound_aligned), ubound_aligned - lbound_aligned, MADV_DONTNEED);
+        if (result == TG_FOUND) {
+            if (tg_compare(&ctx->parser, &stamp, ctx->stop, ctx->stop_key) >= 0) {
+                block->stop = lbound;
+                if (block->start == block->length)
+                    block->start = lbound;
 
-            lbound_aligned = ubound_aligned;
+                break;
+            } else if (block->start == block->length && tg_compare(&ctx->parser, &stamp, ctx->start, ctx->start_key) >= 0) {
+                block->start = lbound;
+                if (before != 0)
+                    break;
+            }
         }
-    }
 
-    if (ubound == ctx->size && write(STDOUT_FILENO, "\n", 1) == -1)
-        return TG_ERROR;
+        lbound += length + 1;
+    }
 
     return TG_FOUND;
 }
 
 /**
- * Read string from file and dynamically (re)allocate frame data if needed
- * Return TG_FOUND on success
- * Return TG_NOT_FOUND on EOF
- * Retrun TG_ERROR on error, errno is set on system error
+ * --jobs stream pipeline worker thread
  */
-static int tg_read_stream_string(
-    int     fd,       /* file descriptor                 */
-    size_t  chunk,    /* io / memory chunk size          */
-    char**  data,     /* frame data (may be reallocated) */
-    size_t* size,     /* frame size (may be resized)     */
-    size_t  lbound,   /* lower bound frame position      */
-    size_t* ubound,   /* upper bound frame position      */
-    size_t* length    /* found string length             */
-)
+static void* tg_pipeline_worker(void* arg)
 {
-    char*   nl;
-    char*   buffer;
-    ssize_t actual;
-
-    nl = memchr((*data) + lbound, '\n', (*ubound) - lbound);
-    if (nl != NULL) {
-        *length = (size_t)(nl - (*data)) - lbound;
-        return TG_FOUND;
-    }
+    int          result;
+    tg_block*    block;
+    tg_worker*   worker   = arg;
+    tg_pipeline* pipeline = worker->pipeline;
 
     while (1) {
-        if ((*size) - (*ubound) < chunk) {
-            buffer = realloc(*data, (*size) + chunk * 2);
-            if (buffer == NULL)
-                return TG_ERROR;
+        pthread_mutex_lock(&pipeline->mutex);
 
-            *data  = buffer;
-            *size += chunk * 2;
+        while (pipeline->cancel == 0 && pipeline->taken == pipeline->filled && pipeline->eof == 0)
+            pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+
+        if (pipeline->cancel != 0 || pipeline->taken == pipeline->filled) {
+            pthread_mutex_unlock(&pipeline->mutex);
+            break;
         }
 
-        actual = read(fd, (*data) + (*ubound), chunk);
-        if (actual == -1)
-            return TG_ERROR;
-        else if (actual == 0)
-            return TG_NOT_FOUND;
+        block        = pipeline->blocks + pipeline->taken % pipeline->count;
+        block->state = TG_BLOCK_TAKEN;
+        pipeline->taken++;
 
-        nl = memchr((*data) + (*ubound), '\n', (size_t)actual);
+        pthread_mutex_unlock(&pipeline->mutex);
 
-        *ubound += (size_t)actual;
+        result = tg_pipeline_parse(&worker->ctx, block);
 
-        if (nl != NULL) {
-            *length = (size_t)(nl - (*data)) - lbound;
-            break;
+        pthread_mutex_lock(&pipeline->mutex);
+
+        if (result == TG_ERROR)
+            tg_pipeline_error(pipeline, errno);
+        else {
+            block->state = TG_BLOCK_PARSED;
+            pthread_cond_broadcast(&pipeline->cond);
         }
+
+        pthread_mutex_unlock(&pipeline->mutex);
     }
 
-    return TG_FOUND;
+    return NULL;
 }
 
 /**
- * Stream timegrep with sequential search
+ * Write parsed blocks of pipeline in stream order until stop is found (main thread)
  * Return TG_FOUND on success
  * Return TG_NOT_FOUND if nothing found
- * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ * Retrun TG_ERROR on error, errno is set
  */
-static int tg_stream_timegrep(const tg_context* ctx)
+static int tg_pipeline_writer(tg_pipeline* pipeline)
 {
-    int     result;
-    ssize_t actual;
-    size_t  length;
-    time_t  timestamp;
-    char*   data   = NULL;
-    size_t  size   = 0;
-    size_t  lbound = 0;
-    size_t  ubound = 0;
-    int     stream = 0;
+    int       result;
+    size_t    lbound;
+    tg_block* block;
+    int       stream = 0;
 
     while (1) {
-        result = tg_read_stream_string(ctx->fd, ctx->chunk, &data, &size, lbound, &ubound, &length);
-        if (result == TG_ERROR)
-            goto ERROR;
-        else if (result == TG_NOT_FOUND)
+        pthread_mutex_lock(&pipeline->mutex);
+
+        block = pipeline->blocks + pipeline->written % pipeline->count;
+        while (
+            pipeline->cancel == 0 &&
+            (pipeline->written == pipeline->filled ? pipeline->eof == 0 : block->state != TG_BLOCK_PARSED)
+        )
+            pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+
+        result = (pipeline->cancel != 0 || pipeline->written == pipeline->filled);
+        pthread_mutex_unlock(&pipeline->mutex);
+
+        if (result != 0)
             break;
 
-        result = tg_get_timestamp(data + lbound, length, &ctx->parser, &timestamp);
+        lbound = 0;
+        if (stream == 0 && block->start < block->stop) {
+            stream = 1;
+            lbound = block->start;
+        }
+
+        result = TG_FOUND;
+        if (stream == 1 && lbound < block->stop)
+            result = tg_write(STDOUT_FILENO, block->data + lbound, block->stop - lbound);
+
+        pthread_mutex_lock(&pipeline->mutex);
+
         if (result == TG_ERROR)
-            goto ERROR;
+            tg_pipeline_error(pipeline, errno);
+        else if (block->stop < block->length)
+            pipeline->cancel = 1;
 
-        if (result == TG_FOUND) {
-            if (timestamp >= ctx->stop)
-                break;
-            else if (stream == 0 && timestamp >= ctx->start)
-                stream = 1;
-        }
+        block->state = TG_BLOCK_FREE;
+        pipeline->written++;
 
-        if (stream == 1) {
-            length++;
+        pthread_cond_broadcast(&pipeline->cond);
+        pthread_mutex_unlock(&pipeline->mutex);
+    }
 
-            while (length > 0) {
-                actual = write(STDOUT_FILENO, data + lbound, length);
-                if (actual == -1)
-                    goto ERROR;
+    return (stream == 1 ? TG_FOUND : TG_NOT_FOUND);
+}
 
-                length -= (size_t)actual;
-                lbound += (size_t)actual;
-            }
-        } else
-            lbound += length + 1;
+/**
+ * Stream timegrep on --jobs threads (see tg_pipeline)
+ * Every worker has own copy of context (parser)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_stream_jobs(tg_context* ctx, const tg_reader* reader)
+{
+    int         result;
+    size_t      i;
+    size_t      created;
+    pthread_t   thread[TG_JOBS_THREADS];
+    pthread_t   thread_reader;
+    tg_worker*  worker;
+    tg_pipeline pipeline;
+
+    memset(&pipeline, 0, sizeof(pipeline));
+
+    pipeline.reader = reader;
+    pipeline.fd     = ctx->fd;
+    pipeline.chunk  = ctx->chunk;
+    pipeline.max    = ctx->max_line;
+    pipeline.count  = ctx->jobs * 2;
+    pipeline.result = TG_FOUND;
+
+    worker = calloc(ctx->jobs, sizeof(tg_worker));
+    if (worker == NULL)
+        return TG_ERROR;
 
-        if (ubound - lbound < lbound) {
-            memmove(data, data + lbound, ubound - lbound);
+    pipeline.blocks = calloc(pipeline.count, sizeof(tg_block));
+    if (pipeline.blocks == NULL) {
+        free(worker);
+        return TG_ERROR;
+    }
 
-            ubound = ubound - lbound;
-            lbound = 0;
-        }
+    errno = pthread_mutex_init(&pipeline.mutex, NULL);
+    if (errno != 0) {
+        free(pipeline.blocks);
+        free(worker);
+        return TG_ERROR;
     }
 
-    free(data);
+    errno = pthread_cond_init(&pipeline.cond, NULL);
+    if (errno != 0) {
+        pthread_mutex_destroy(&pipeline.mutex);
+        free(pipeline.blocks);
+        free(worker);
+        return TG_ERROR;
+    }
 
-    return (stream == 1 ? TG_FOUND : TG_NOT_FOUND);
+    for (created = 0; created < ctx->jobs; created++) {
+        worker[created].ctx      = *ctx;
+        worker[created].pipeline = &pipeline;
 
-ERROR:
+        errno = pthread_create(&thread[created], NULL, tg_pipeline_worker, &worker[created]);
+        if (errno != 0)
+            break;
+    }
 
-    result = errno;
+    if (created == ctx->jobs)
+        errno = pthread_create(&thread_reader, NULL, tg_pipeline_reader, &pipeline);
 
-    free(data);
+    if (created != ctx->jobs || errno != 0) {
+        result = TG_ERROR;
 
-    errno = result;
+        pthread_mutex_lock(&pipeline.mutex);
+        tg_pipeline_error(&pipeline, errno);
+        pthread_mutex_unlock(&pipeline.mutex);
+    } else {
+        result = tg_pipeline_writer(&pipeline);
 
-    return TG_ERROR;
+        /* reader may wait for data after stop is found */
+        pthread_cancel(thread_reader);
+        pthread_join(thread_reader, NULL);
+    }
+
+    for (i = 0; i < created; i++)
+        pthread_join(thread[i], NULL);
+
+    if (pipeline.result == TG_ERROR) {
+        errno  = pipeline.error;
+        result = TG_ERROR;
+    }
+
+    for (i = 0; i < pipeline.count; i++)
+        free(pipeline.blocks[i].data);
+
+    free(pipeline.blocks);
+    free(pipeline.tail);
+    free(worker);
+
+    pthread_cond_destroy(&pipeline.cond);
+    pthread_mutex_destroy(&pipeline.mutex);
+
+    return result;
+}
+
+/**
+ * Stream timegrep with sequential search (pipeline on --jobs threads)
+ * Return TG_FOUND on success
+ * Return TG_NOT_FOUND if nothing found
+ * Retrun TG_ERROR on error, errno is set on system error and 0 on pcre error
+ */
+static int tg_stream_timegrep(tg_context* ctx)
+{
+    tg_reader reader;
+
+    reader.read   = tg_read_fd;
+    reader.source = &ctx->fd;
+
+    if (ctx->jobs > 1)
+        return tg_stream_jobs(ctx, &reader);
+
+    return tg_stream_filter(ctx, &reader, 0, 0);
 }
 
 /**
@@ -1369,6 +6859,12 @@ int tg_parse_options(int argc, char* argv[], tg_context* ctx)
 
     int result = TG_NOT_FOUND;
 
+    ctx->parser.window_auto = 1;
+    ctx->search             = TG_SEARCH_AUTO;
+    ctx->mtime_slack        = TG_MTIME_SLACK;
+    ctx->jobs               = 1;
+    ctx->max_line           = TG_MAX_LINE_LENGTH;
+
     while (1) {
         static struct option long_options[] = {
             { "format",  required_argument, 0, 'e' },
@@ -1377,12 +6873,24 @@ int tg_parse_options(int argc, char* argv[], tg_context* ctx)
             { "seconds", required_argument, 0, 's' },
             { "minutes", required_argument, 0, 'm' },
             { "hours",   required_argument, 0, 'h' },
+            { "anchor",  required_argument, 0, 'a' },
+            { "ts-window", required_argument, 0, 'w' },
+            { "search",  required_argument, 0, 'S' },
+            { "build-index", no_argument,   0, 'i' },
+            { "state",   required_argument, 0, 'T' },
+            { "verify-sorted", no_argument, 0, 'c' },
+            { "tolerance", required_argument, 0, 'l' },
+            { "recursive", no_argument,     0, 'R' },
+            { "mtime-slack", required_argument, 0, 'k' },
+            { "jobs",    required_argument, 0, 'j' },
+            { "merge",   no_argument,       0, 'M' },
+            { "max-line-length", required_argument, 0, 'L' },
             { "version", no_argument,       0, 'v' },
             { "help",    no_argument,       0, '?' },
             { NULL, 0, NULL, 0 }
         };
 
-        option = getopt_long(argc, argv, "r:e:f:t:s:m:h:v?", long_options, &index);
+        option = getopt_long(argc, argv, "r:e:f:t:s:m:h:a:w:S:iT:cl:Rk:j:ML:v?", long_options, &index);
 
         if (option == -1)
             break;
@@ -1415,6 +6923,95 @@ int tg_parse_options(int argc, char* argv[], tg_context* ctx)
                     goto ERROR;
                 offset += value;
                 break;
+            case 'a':
+                if (strcmp(optarg, "auto") == 0)
+                    ctx->parser.anchor = TG_ANCHOR_AUTO;
+                else if (strcmp(optarg, "start") == 0)
+                    ctx->parser.anchor = TG_ANCHOR_START;
+                else if (strcmp(optarg, "none") == 0)
+                    ctx->parser.anchor = TG_ANCHOR_NONE;
+                else {
+                    errno = 0;
+                    fprintf(stderr, gettext("%s Unknown anchor mode '%s'\n"), gettext("ERROR:"), optarg);
+                    goto ERROR;
+                }
+                break;
+            case 'w':
+                if (strcmp(optarg, "auto") == 0)
+                    ctx->parser.window_auto = 1;
+                else {
+                    value = tg_parse_interval(optarg, 1);
+                    if (value == LONG_MIN)
+                        goto ERROR;
+
+                    ctx->parser.window      = (size_t)value;
+                    ctx->parser.window_auto = 0;
+                }
+                break;
+            case 'S':
+                if (strcmp(optarg, "auto") == 0)
+                    ctx->search = TG_SEARCH_AUTO;
+                else if (strcmp(optarg, "binary") == 0)
+                    ctx->search = TG_SEARCH_BINARY;
+                else if (strcmp(optarg, "interpolation") == 0)
+                    ctx->search = TG_SEARCH_INTERPOLATION;
+                else if (strcmp(optarg, "tail") == 0)
+                    ctx->search = TG_SEARCH_TAIL;
+                else {
+                    errno = 0;
+                    fprintf(stderr, gettext("%s Unknown search strategy '%s'\n"), gettext("ERROR:"), optarg);
+                    goto ERROR;
+                }
+                break;
+            case 'i':
+                ctx->index = 1;
+                break;
+            case 'T':
+                ctx->state = optarg;
+                break;
+            case 'c':
+                ctx->verify = 1;
+                break;
+            case 'l':
+                value = tg_parse_interval(optarg, 1);
+                if (value == LONG_MIN)
+                    goto ERROR;
+
+                ctx->tolerance = (time_t)value;
+                break;
+            case 'R':
+                ctx->recursive = 1;
+                break;
+            case 'k':
+                value = tg_parse_interval(optarg, 1);
+                if (value == LONG_MIN)
+                    goto ERROR;
+
+                ctx->mtime_slack = (time_t)value;
+                break;
+            case 'j':
+                value = tg_parse_interval(optarg, 1);
+                if (value == LONG_MIN)
+                    goto ERROR;
+
+                if (value == 0) {
+                    value = sysconf(_SC_NPROCESSORS_ONLN);
+                    if (value < 1)
+                        value = 1;
+                }
+
+                ctx->jobs = (size_t)(value < TG_JOBS_THREADS ? value : TG_JOBS_THREADS);
+                break;
+            case 'M':
+                ctx->merge = 1;
+                break;
+            case 'L':
+                value = tg_parse_interval(optarg, 1);
+                if (value == LONG_MIN)
+                    goto ERROR;
+
+                ctx->max_line = (size_t)value;
+                break;
             case 'v':
                 tg_print_version();
                 goto SUCCESS;
@@ -1447,6 +7044,16 @@ int tg_parse_options(int argc, char* argv[], tg_context* ctx)
     } else
         ctx->parser.format = TG_FORMATS[0].format;
 
+    index = 0;
+    while (TG_FORMATS[index].name != NULL) {
+        if (TG_FORMATS[index].format != NULL && strcmp(ctx->parser.format, TG_FORMATS[index].format) == 0) {
+            ctx->parser.scan = TG_FORMATS[index].scan;
+            break;
+        }
+
+        index++;
+    }
+
     regex_len = tg_strptime_regex(ctx->parser.format, NULL, NULL, NULL);
     if (regex_len == SIZE_MAX)
         goto ERROR;
@@ -1494,9 +7101,12 @@ int tg_parse_options(int argc, char* argv[], tg_context* ctx)
         ctx->parser.nsi.timestamp = pcre_get_stringnumber(ctx->parser.re, "timestamp");
     }
 
+    if (ctx->search == TG_SEARCH_AUTO)
+        ctx->search = (to == NULL ? TG_SEARCH_TAIL : TG_SEARCH_INTERPOLATION);
+
     if (to == NULL)
         ctx->stop = time(NULL);
-    else if (tg_strptime(to, ctx->parser.format, ctx->parser.format_tz, &ctx->stop) == TG_NOT_FOUND && tg_strptime_heuristic(to, &ctx->stop) == TG_NOT_FOUND) {
+    else if (tg_strptime(to, ctx->parser.format, ctx->parser.format_tz, NULL, &ctx->stop) == TG_NOT_FOUND && tg_strptime_heuristic(to, &ctx->stop) == TG_NOT_FOUND) {
         errno = 0;
         fprintf(stderr, gettext("%s Can not convert argument '%s' to timestamp\n"), gettext("ERROR:"), to);
         goto ERROR;
@@ -1504,12 +7114,21 @@ int tg_parse_options(int argc, char* argv[], tg_context* ctx)
 
     if (from == NULL)
         ctx->start = ctx->stop - offset;
-    else if (tg_strptime(from, ctx->parser.format, ctx->parser.format_tz, &ctx->start) == TG_NOT_FOUND && tg_strptime_heuristic(from, &ctx->start) == TG_NOT_FOUND) {
+    else if (tg_strptime(from, ctx->parser.format, ctx->parser.format_tz, NULL, &ctx->start) == TG_NOT_FOUND && tg_strptime_heuristic(from, &ctx->start) == TG_NOT_FOUND) {
         errno = 0;
         fprintf(stderr, gettext("%s Can not convert argument '%s' to timestamp\n"), gettext("ERROR:"), from);
         goto ERROR;
     }
 
+    ctx->parser.lexical = tg_strftime_lexical(ctx->parser.format, NULL, NULL);
+    if (
+        ctx->parser.lexical == SIZE_MAX ||
+        ctx->parser.lexical >= TG_KEY_SIZE ||
+        tg_strftime_lexical(ctx->parser.format, &ctx->start, ctx->start_key) != ctx->parser.lexical ||
+        tg_strftime_lexical(ctx->parser.format, &ctx->stop, ctx->stop_key) != ctx->parser.lexical
+    )
+        ctx->parser.lexical = 0;
+
     /* TODO: adjust from command line */
     ctx->chunk = TG_CHUNK_SIZE;
 
@@ -1539,17 +7158,22 @@ SUCCESS:
  */
 int main(int argc, char* argv[])
 {
-    int         result;
-    int         retval;
-    struct stat file_stat;
-    tg_context  ctx;
+    int          result;
+    int          retval;
+    size_t       i;
+    time_t       mtime;
+    struct stat  file_stat;
+    tg_context   ctx;
+    tg_filenames files;
 
     tg_set_timezone();
 
     memset(&ctx, 0, sizeof(ctx));
+    memset(&files, 0, sizeof(files));
 
-    ctx.fd   = -1;
-    ctx.data = MAP_FAILED;
+    ctx.fd         = -1;
+    ctx.data       = MAP_FAILED;
+    ctx.index_data = MAP_FAILED;
 
     result = tg_parse_options(argc, argv, &ctx);
     if (result == TG_NOT_FOUND) {
@@ -1558,39 +7182,75 @@ int main(int argc, char* argv[])
     } else if (result == TG_ERROR)
         goto ERROR;
 
-    if (optind < argc) {
-        result = TG_NOT_FOUND;
-        while (optind < argc) {
-            ctx.filename = argv[optind++];
+    if (ctx.state != NULL && ctx.index == 0 && ctx.verify == 0) {
+        if (optind + 1 != argc) {
+            errno = 0;
+            fprintf(stderr, gettext("%s State requires single file\n"), gettext("ERROR:"));
+            goto ERROR;
+        }
 
-            ctx.fd = open(ctx.filename, O_RDONLY);
-            if (ctx.fd == -1)
-                goto ERROR;
+        ctx.filename = argv[optind];
 
-            if (fstat(ctx.fd, &file_stat) == -1)
+        result = tg_state_timegrep(&ctx);
+        if (result == TG_ERROR)
+            goto ERROR;
+    } else if (optind < argc && ctx.index == 0 && ctx.verify == 0) {
+        mtime = ctx.start - ctx.mtime_slack;
+        while (optind < argc)
+            if (tg_files_collect(&ctx, &files, argv[optind++], &mtime, 0) == TG_ERROR)
                 goto ERROR;
-            else if (file_stat.st_size == 0)
-                goto SUCCESS;
 
-            /* preferred to compile with -D_FILE_OFFSET_BITS=64 */
-            ctx.size = (size_t)file_stat.st_size;
-
-            ctx.data = mmap(NULL, ctx.size, PROT_READ, MAP_PRIVATE, ctx.fd, 0);
-            if (ctx.data == MAP_FAILED)
+        result = tg_files_timegrep(&ctx, files.filename, files.count);
+        if (result == TG_ERROR)
+            goto ERROR;
+    } else if (optind < argc) {
+        while (optind < argc)
+            if (tg_files_collect(&ctx, &files, argv[optind++], NULL, 0) == TG_ERROR)
                 goto ERROR;
 
-            close(ctx.fd);
-            ctx.fd = -1;
+        result = (ctx.verify != 0 ? TG_FOUND : TG_NOT_FOUND);
+        for (i = 0; i < files.count; i++) {
+            ctx.filename = files.filename[i];
 
-            retval = tg_file_timegrep(&ctx);
+            retval = tg_file_map(&ctx, &file_stat);
             if (retval == TG_ERROR)
                 goto ERROR;
-            else if (retval == TG_FOUND)
+            else if (retval == TG_NOT_FOUND) {
+                /* empty file is sorted and has nothing to index, go on with the rest */
+                if (ctx.index != 0)
+                    result = TG_FOUND;
+
+                tg_file_unmap(&ctx);
+                continue;
+            }
+
+            if (ctx.index != 0) {
+                if (tg_file_compressed(&ctx) != TG_COMPRESSED_NONE)
+                    retval = tg_compressed_index(&ctx, &file_stat);
+                else
+                    retval = tg_file_index(&ctx, &file_stat);
+                if (retval == TG_ERROR)
+                    goto ERROR;
+
                 result = TG_FOUND;
+            } else {
+                retval = tg_file_verify(&ctx);
+                if (retval == TG_ERROR)
+                    goto ERROR;
+                else if (retval == TG_NOT_FOUND)
+                    result = TG_NOT_FOUND;
+            }
 
-            munmap(ctx.data, ctx.size);
-            ctx.data = MAP_FAILED;
+            tg_file_unmap(&ctx);
         }
+    } else if (ctx.index != 0) {
+        errno = 0;
+        fprintf(stderr, gettext("%s Sparse index requires files\n"), gettext("ERROR:"));
+        goto ERROR;
+    } else if (ctx.verify != 0) {
+        errno = 0;
+        fprintf(stderr, gettext("%s Sorted verification requires files\n"), gettext("ERROR:"));
+        goto ERROR;
     } else {
         ctx.fd = STDIN_FILENO;
         result = tg_stream_timegrep(&ctx);
@@ -1609,6 +7269,8 @@ ERROR:
 
 SUCCESS:
 
+    tg_filenames_free(&files);
+
     if (ctx.parser.re != NULL)
         pcre_free(ctx.parser.re);
 
@@ -1622,6 +7284,9 @@ SUCCESS:
     if (ctx.data != MAP_FAILED)
         munmap(ctx.data, ctx.size);
 
+    if (ctx.index_data != MAP_FAILED)
+        munmap(ctx.index_data, ctx.index_size);
+
     if (ctx.fd != -1 && ctx.fd != STDIN_FILENO)
         close(ctx.fd);
 
@@ -6,6 +6,9 @@ Group:         Productivity/Text/Utilities
 License:       BSD-2-Clause
 URL:           https://github.com/abbat/timegrep
 BuildRequires: pcre-devel
+BuildRequires: zlib-devel
+BuildRequires: libzstd-devel
+BuildRequires: xz-devel
 Source0:       https://build.opensuse.org/source/home:antonbatenev:timegrep/timegrep/timegrep_%{version}.tar.bz2
 BuildRoot:     %{_tmppath}/%{name}-%{version}-build
 